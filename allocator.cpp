@@ -0,0 +1,366 @@
+#include "allocator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+uint32_t Allocator::orderFor(vk::DeviceSize size) {
+
+    uint32_t order = 0;
+    for(vk::DeviceSize nodeSize = MinNodeSize; nodeSize < size; nodeSize <<= 1) {
+        order++;
+    }
+
+    return order;
+}
+
+void Allocator::create(vk::PhysicalDevice physicalDevice, vk::Device device, vk::DispatchLoaderDynamic const& loader, vk::DeviceSize blockSize) {
+
+    m_physicalDevice = physicalDevice;
+    m_device = device;
+    m_memoryProperties = physicalDevice.getMemoryProperties(loader);
+    m_blockSize = std::bit_ceil(std::max(blockSize, MinNodeSize));
+
+    auto const limits = physicalDevice.getProperties(loader).limits;
+    m_bufferImageGranularity = limits.bufferImageGranularity;
+    m_maxAllocationCount = limits.maxMemoryAllocationCount;
+}
+
+void Allocator::destroy(vk::DispatchLoaderDynamic const& loader) {
+
+    std::scoped_lock lock(m_mutex);
+
+    for(auto& block : m_blocks) {
+        destroyBlock(block, loader);
+    }
+
+    m_blocks.clear();
+    m_allocationCount = 0;
+    m_requestedBytes = 0;
+}
+
+uint32_t Allocator::findMemoryType(uint32_t typeBits, vk::MemoryPropertyFlags properties) const {
+
+    for(uint32_t x=0; x<m_memoryProperties.memoryTypeCount; x++) {
+        if((typeBits & (1u << x)) && (m_memoryProperties.memoryTypes[x].propertyFlags & properties) == properties) {
+            return x;
+        }
+    }
+
+    throw std::runtime_error("Error: Allocator::findMemoryType()");
+}
+
+vk::PhysicalDeviceMemoryProperties const& Allocator::memoryProperties() const {
+    return m_memoryProperties;
+}
+
+uint32_t Allocator::createBlock(uint32_t memoryType, ResourceKind kind, vk::DeviceSize size, bool dedicated, vk::DispatchLoaderDynamic const& loader) {
+
+    if(m_deviceAllocationCount >= m_maxAllocationCount) {
+        throw std::runtime_error("Error: Allocator::createBlock() maxMemoryAllocationCount reached");
+    }
+
+    Block block
+    {
+        .memory = {},
+        .size = size,
+        .mapped = {},
+        .memoryType = memoryType,
+        .kind = kind,
+        .dedicated = dedicated,
+        .used = {},
+        .freeLists = {}
+    };
+
+    vk::MemoryAllocateInfo const memoryAllocateInfo
+    {
+        .sType = vk::StructureType::eMemoryAllocateInfo,
+        .pNext = {},
+        .allocationSize = size,
+        .memoryTypeIndex = memoryType
+    };
+
+    vk::Result result = m_device.allocateMemory(&memoryAllocateInfo, nullptr, &block.memory, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: Allocator::createBlock()");
+    }
+    m_deviceAllocationCount++;
+
+    if(m_memoryProperties.memoryTypes[memoryType].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) {
+        result = m_device.mapMemory(block.memory, 0, VK_WHOLE_SIZE, {}, &block.mapped, loader);
+        if(result != vk::Result::eSuccess) {
+            m_device.freeMemory(block.memory, nullptr, loader);
+            m_deviceAllocationCount--;
+            throw std::runtime_error("Error: Allocator::createBlock() map");
+        }
+    }
+
+    if(!dedicated) {
+        block.freeLists.resize(orderFor(size) + 1);
+        block.freeLists.back().insert(0);
+    }
+
+    auto const empty = std::ranges::find_if(m_blocks, [](Block const& block) { return !block.memory; });
+    if(empty != m_blocks.end()) {
+        *empty = std::move(block);
+        return static_cast<uint32_t>(std::distance(m_blocks.begin(), empty));
+    }
+
+    m_blocks.push_back(std::move(block));
+    return static_cast<uint32_t>(m_blocks.size() - 1);
+}
+
+void Allocator::destroyBlock(Block& block, vk::DispatchLoaderDynamic const& loader) {
+
+    if(!block.memory) {
+        return;
+    }
+
+    if(block.mapped) m_device.unmapMemory(block.memory, loader);
+    m_device.freeMemory(block.memory, nullptr, loader);
+    m_deviceAllocationCount--;
+
+    block = Block {};
+}
+
+std::optional<vk::DeviceSize> Allocator::takeNode(Block& block, uint32_t order) {
+
+    uint32_t available = order;
+    while(available < block.freeLists.size() && block.freeLists[available].empty()) {
+        available++;
+    }
+
+    if(available >= block.freeLists.size()) {
+        return std::nullopt;
+    }
+
+    vk::DeviceSize const offset = *block.freeLists[available].begin();
+    block.freeLists[available].erase(block.freeLists[available].begin());
+
+    while(available > order) {
+        available--;
+        block.freeLists[available].insert(offset + (MinNodeSize << available));
+    }
+
+    block.used += MinNodeSize << order;
+    return offset;
+}
+
+void Allocator::releaseNode(Block& block, vk::DeviceSize offset, uint32_t order) {
+
+    block.used -= MinNodeSize << order;
+
+    while(order + 1 < block.freeLists.size()) {
+        vk::DeviceSize const buddy = offset ^ (MinNodeSize << order);
+        auto const iter = block.freeLists[order].find(buddy);
+        if(iter == block.freeLists[order].end()) {
+            break;
+        }
+        block.freeLists[order].erase(iter);
+        offset = std::min(offset, buddy);
+        order++;
+    }
+
+    block.freeLists[order].insert(offset);
+}
+
+Allocation Allocator::allocate(vk::MemoryRequirements const& requirements, vk::MemoryPropertyFlags properties, ResourceKind kind, vk::DispatchLoaderDynamic const& loader) {
+
+    std::scoped_lock lock(m_mutex);
+
+    uint32_t const memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+    if(m_bufferImageGranularity <= 1) {
+        kind = ResourceKind::eLinear;
+    }
+
+    vk::DeviceSize const size = std::max(requirements.size, requirements.alignment);
+
+    if(size > m_blockSize / 2) {
+        uint32_t const blockIndex = createBlock(memoryType, kind, requirements.size, true, loader);
+        Block& block = m_blocks[blockIndex];
+        block.used = requirements.size;
+
+        m_allocationCount++;
+        m_requestedBytes += requirements.size;
+        return Allocation { .memory = block.memory, .offset = 0, .size = requirements.size, .mapped = block.mapped, .block = blockIndex, .order = 0 };
+    }
+
+    uint32_t const order = orderFor(size);
+
+    for(uint32_t x=0; x<m_blocks.size(); x++) {
+        Block& block = m_blocks[x];
+        if(!block.memory || block.dedicated || block.memoryType != memoryType || block.kind != kind) {
+            continue;
+        }
+
+        if(auto offset = takeNode(block, order)) {
+            m_allocationCount++;
+            m_requestedBytes += requirements.size;
+            void* mapped = block.mapped ? static_cast<std::byte*>(block.mapped) + *offset : nullptr;
+            return Allocation { .memory = block.memory, .offset = *offset, .size = requirements.size, .mapped = mapped, .block = x, .order = order };
+        }
+    }
+
+    uint32_t const blockIndex = createBlock(memoryType, kind, m_blockSize, false, loader);
+    Block& block = m_blocks[blockIndex];
+    vk::DeviceSize const offset = *takeNode(block, order);
+
+    m_allocationCount++;
+    m_requestedBytes += requirements.size;
+    void* mapped = block.mapped ? static_cast<std::byte*>(block.mapped) + offset : nullptr;
+    return Allocation { .memory = block.memory, .offset = offset, .size = requirements.size, .mapped = mapped, .block = blockIndex, .order = order };
+}
+
+Allocation Allocator::allocateBuffer(vk::Buffer buffer, vk::MemoryPropertyFlags properties, vk::DispatchLoaderDynamic const& loader) {
+
+    auto const requirements = m_device.getBufferMemoryRequirements(buffer, loader);
+    Allocation allocation = allocate(requirements, properties, ResourceKind::eLinear, loader);
+    m_device.bindBufferMemory(buffer, allocation.memory, allocation.offset, loader);
+    return allocation;
+}
+
+Allocation Allocator::allocateImage(vk::Image image, vk::MemoryPropertyFlags properties, vk::DispatchLoaderDynamic const& loader) {
+
+    auto const requirements = m_device.getImageMemoryRequirements(image, loader);
+    Allocation allocation = allocate(requirements, properties, ResourceKind::eOptimal, loader);
+    m_device.bindImageMemory(image, allocation.memory, allocation.offset, loader);
+    return allocation;
+}
+
+void Allocator::free(Allocation const& allocation, vk::DispatchLoaderDynamic const& loader) {
+
+    std::scoped_lock lock(m_mutex);
+
+    if(allocation.block >= m_blocks.size()) {
+        return;
+    }
+
+    Block& block = m_blocks[allocation.block];
+    m_allocationCount--;
+    m_requestedBytes -= allocation.size;
+
+    if(block.dedicated) {
+        destroyBlock(block, loader);
+        return;
+    }
+
+    releaseNode(block, allocation.offset, allocation.order);
+}
+
+void Allocator::trim(vk::DispatchLoaderDynamic const& loader) {
+
+    std::scoped_lock lock(m_mutex);
+
+    for(auto& block : m_blocks) {
+        if(block.memory && !block.dedicated && block.used == 0) {
+            destroyBlock(block, loader);
+        }
+    }
+}
+
+AllocatorStatistics Allocator::statistics() const {
+
+    std::scoped_lock lock(m_mutex);
+
+    AllocatorStatistics statistics
+    {
+        .reservedBytes = {},
+        .usedBytes = {},
+        .requestedBytes = m_requestedBytes,
+        .largestFreeRange = {},
+        .blockCount = {},
+        .dedicatedCount = {},
+        .allocationCount = m_allocationCount,
+        .fragmentation = {}
+    };
+
+    vk::DeviceSize freeBytes = 0;
+    for(auto const& block : m_blocks) {
+        if(!block.memory) {
+            continue;
+        }
+
+        statistics.reservedBytes += block.size;
+        statistics.usedBytes += block.used;
+        statistics.blockCount++;
+
+        if(block.dedicated) {
+            statistics.dedicatedCount++;
+            continue;
+        }
+
+        freeBytes += block.size - block.used;
+        for(uint32_t order = static_cast<uint32_t>(block.freeLists.size()); order-- > 0;) {
+            if(!block.freeLists[order].empty()) {
+                statistics.largestFreeRange = std::max(statistics.largestFreeRange, MinNodeSize << order);
+                break;
+            }
+        }
+    }
+
+    if(freeBytes != 0) {
+        statistics.fragmentation = 1.0 - static_cast<double>(statistics.largestFreeRange) / static_cast<double>(freeBytes);
+    }
+
+    return statistics;
+}
+
+void LinearPool::create(Allocator& allocator, vk::MemoryRequirements const& requirements, vk::MemoryPropertyFlags properties, ResourceKind kind, vk::DispatchLoaderDynamic const& loader) {
+
+    m_memoryType = allocator.findMemoryType(requirements.memoryTypeBits, properties);
+    m_allocation = allocator.allocate(requirements, properties, kind, loader);
+    m_head = 0;
+}
+
+void LinearPool::destroy(Allocator& allocator, vk::DispatchLoaderDynamic const& loader) {
+
+    allocator.free(m_allocation, loader);
+    m_allocation = Allocation {};
+    m_head = 0;
+}
+
+std::optional<Allocation> LinearPool::allocate(vk::DeviceSize size, vk::DeviceSize alignment) {
+
+    alignment = std::max(alignment, vk::DeviceSize{1});
+    vk::DeviceSize const offset = (m_head + alignment - 1) & ~(alignment - 1);
+    if(offset + size > m_allocation.size) {
+        return std::nullopt;
+    }
+
+    m_head = offset + size;
+
+    return Allocation
+    {
+        .memory = m_allocation.memory,
+        .offset = m_allocation.offset + offset,
+        .size = size,
+        .mapped = m_allocation.mapped ? static_cast<std::byte*>(m_allocation.mapped) + offset : nullptr,
+        .block = UINT32_MAX,
+        .order = 0
+    };
+}
+
+std::optional<Allocation> LinearPool::allocate(vk::MemoryRequirements const& requirements) {
+
+    if(!(requirements.memoryTypeBits & (1u << m_memoryType))) {
+        return std::nullopt;
+    }
+
+    return allocate(requirements.size, requirements.alignment);
+}
+
+void LinearPool::reset() {
+    m_head = 0;
+}
+
+vk::DeviceSize LinearPool::used() const {
+    return m_head;
+}
+
+vk::DeviceSize LinearPool::capacity() const {
+    return m_allocation.size;
+}
+
+Allocation const& LinearPool::allocation() const {
+    return m_allocation;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <vector>
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+// Buffers and linear images never share a block with optimal-tiling images
+// when the device reports a bufferImageGranularity larger than one byte.
+enum class ResourceKind {
+    eLinear,
+    eOptimal
+};
+
+struct Allocation {
+    vk::DeviceMemory                    memory          {};
+    vk::DeviceSize                      offset          {};
+    vk::DeviceSize                      size            {};
+    void*                               mapped          {};
+    uint32_t                            block           {UINT32_MAX};
+    uint32_t                            order           {};
+};
+
+struct AllocatorStatistics {
+    vk::DeviceSize                      reservedBytes       {};
+    vk::DeviceSize                      usedBytes           {};
+    vk::DeviceSize                      requestedBytes      {};
+    vk::DeviceSize                      largestFreeRange    {};
+    uint32_t                            blockCount          {};
+    uint32_t                            dedicatedCount      {};
+    uint32_t                            allocationCount     {};
+    double                              fragmentation       {};
+};
+
+// Large device memory blocks per memory type, sub-allocated with a buddy
+// allocator. Requests larger than half a block get a dedicated allocation.
+class Allocator final {
+
+    public:
+        static constexpr vk::DeviceSize MinNodeSize = 256;
+
+    private:
+        struct Block {
+            vk::DeviceMemory                            memory          {};
+            vk::DeviceSize                              size            {};
+            void*                                       mapped          {};
+            uint32_t                                    memoryType      {};
+            ResourceKind                                kind            {};
+            bool                                        dedicated       {};
+            vk::DeviceSize                              used            {};
+            std::vector<std::set<vk::DeviceSize>>       freeLists       {};
+        };
+
+    private:
+        vk::PhysicalDevice                  m_physicalDevice            {};
+        vk::Device                          m_device                    {};
+        vk::PhysicalDeviceMemoryProperties  m_memoryProperties          {};
+        vk::DeviceSize                      m_blockSize                 {};
+        vk::DeviceSize                      m_bufferImageGranularity    {};
+        uint32_t                            m_maxAllocationCount        {};
+        uint32_t                            m_allocationCount           {};
+        uint32_t                            m_deviceAllocationCount     {};
+        vk::DeviceSize                      m_requestedBytes            {};
+        std::vector<Block>                  m_blocks                    {};
+        mutable std::mutex                  m_mutex                     {};
+
+    private:
+        static uint32_t orderFor(vk::DeviceSize size);
+        uint32_t createBlock(uint32_t memoryType, ResourceKind kind, vk::DeviceSize size, bool dedicated, vk::DispatchLoaderDynamic const& loader);
+        void destroyBlock(Block& block, vk::DispatchLoaderDynamic const& loader);
+        std::optional<vk::DeviceSize> takeNode(Block& block, uint32_t order);
+        void releaseNode(Block& block, vk::DeviceSize offset, uint32_t order);
+
+    public:
+        void create(vk::PhysicalDevice physicalDevice, vk::Device device, vk::DispatchLoaderDynamic const& loader, vk::DeviceSize blockSize = 64ull << 20);
+        void destroy(vk::DispatchLoaderDynamic const& loader);
+
+        uint32_t findMemoryType(uint32_t typeBits, vk::MemoryPropertyFlags properties) const;
+        vk::PhysicalDeviceMemoryProperties const& memoryProperties() const;
+
+        Allocation allocate(vk::MemoryRequirements const& requirements, vk::MemoryPropertyFlags properties, ResourceKind kind, vk::DispatchLoaderDynamic const& loader);
+        Allocation allocateBuffer(vk::Buffer buffer, vk::MemoryPropertyFlags properties, vk::DispatchLoaderDynamic const& loader);
+        Allocation allocateImage(vk::Image image, vk::MemoryPropertyFlags properties, vk::DispatchLoaderDynamic const& loader);
+        void free(Allocation const& allocation, vk::DispatchLoaderDynamic const& loader);
+        void trim(vk::DispatchLoaderDynamic const& loader);
+
+        AllocatorStatistics statistics() const;
+};
+
+// Bump allocator over one allocation for transient data. Everything handed out
+// is released at once by reset().
+class LinearPool final {
+
+    private:
+        Allocation                          m_allocation                {};
+        uint32_t                            m_memoryType                {};
+        vk::DeviceSize                      m_head                      {};
+
+    public:
+        void create(Allocator& allocator, vk::MemoryRequirements const& requirements, vk::MemoryPropertyFlags properties, ResourceKind kind, vk::DispatchLoaderDynamic const& loader);
+        void destroy(Allocator& allocator, vk::DispatchLoaderDynamic const& loader);
+
+        std::optional<Allocation> allocate(vk::DeviceSize size, vk::DeviceSize alignment);
+        std::optional<Allocation> allocate(vk::MemoryRequirements const& requirements);
+        void reset();
+
+        vk::DeviceSize used() const;
+        vk::DeviceSize capacity() const;
+        Allocation const& allocation() const;
+};
@@ -0,0 +1,607 @@
+#include "batchrenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+void BatchRenderer::create(vk::Device device, Allocator& allocator, Shaders const& shaders, vk::RenderPass renderPass, vk::Format colorFormat, vk::PipelineCache cache, vk::DispatchLoaderDynamic const& loader,
+    uint32_t instanceCapacity, uint32_t meshCapacity, uint32_t vertexCapacity, uint32_t indexCapacity) {
+
+    m_device = device;
+    m_allocator = &allocator;
+    m_shaders = shaders;
+    m_cache = cache;
+    m_instanceCapacity = instanceCapacity;
+    m_meshCapacity = meshCapacity;
+
+    auto const storage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst;
+
+    createBuffer(ePositions, sizeof(float) * 4 * instanceCapacity, storage, loader);
+    createBuffer(eOrientations, sizeof(float) * 4 * instanceCapacity, storage, loader);
+    createBuffer(eMeshIndices, sizeof(uint32_t) * instanceCapacity, storage, loader);
+    createBuffer(eMeshes, sizeof(Mesh) * meshCapacity, storage, loader);
+    createBuffer(eDraws, sizeof(vk::DrawIndexedIndirectCommand) * instanceCapacity, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer, loader);
+    createBuffer(eDrawCount, sizeof(uint32_t), storage | vk::BufferUsageFlagBits::eIndirectBuffer, loader);
+    createBuffer(eVertices, sizeof(BatchVertex) * vertexCapacity, vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst, loader);
+    createBuffer(eIndices, sizeof(uint32_t) * indexCapacity, vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst, loader);
+
+    createDescriptors(shaders, loader);
+    createPipelines(shaders, renderPass, colorFormat, cache, loader);
+}
+
+void BatchRenderer::createBuffer(BufferIndex index, vk::DeviceSize size, vk::BufferUsageFlags usage, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::BufferCreateInfo const bufferCreateInfo
+    {
+        .sType = vk::StructureType::eBufferCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .size = size,
+        .usage = usage,
+        .sharingMode = vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = {},
+        .pQueueFamilyIndices = {}
+    };
+
+    Buffer& buffer = m_buffers[index];
+    vk::Result result = m_device.createBuffer(&bufferCreateInfo, nullptr, &buffer.buffer, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BatchRenderer::createBuffer()");
+    }
+
+    buffer.allocation = m_allocator->allocateBuffer(buffer.buffer, vk::MemoryPropertyFlagBits::eDeviceLocal, loader);
+    buffer.size = size;
+}
+
+vk::ShaderModule BatchRenderer::createShaderModule(std::span<uint32_t const> code, vk::DispatchLoaderDynamic const& loader) const {
+
+    vk::ShaderModuleCreateInfo const shaderModuleCreateInfo
+    {
+        .sType = vk::StructureType::eShaderModuleCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .codeSize = code.size_bytes(),
+        .pCode = code.data()
+    };
+
+    vk::ShaderModule shaderModule;
+    vk::Result result = m_device.createShaderModule(&shaderModuleCreateInfo, nullptr, &shaderModule, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BatchRenderer::createShaderModule()");
+    }
+    return shaderModule;
+}
+
+void BatchRenderer::createDescriptors(Shaders const& shaders, vk::DispatchLoaderDynamic const& loader) {
+
+    std::array const stages { &shaders.cull, &shaders.vertex };
+    auto const bindings = EmbeddedShader::setLayoutBindings(stages, 0);
+
+    for(auto const& binding : bindings) {
+        if(binding.binding >= eVertices || binding.descriptorType != vk::DescriptorType::eStorageBuffer) {
+            throw std::runtime_error("Error: BatchRenderer::createDescriptors() unexpected shader binding");
+        }
+    }
+
+    vk::DescriptorSetLayoutCreateInfo const descriptorSetLayoutCreateInfo
+    {
+        .sType = vk::StructureType::eDescriptorSetLayoutCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
+    };
+
+    vk::Result result = m_device.createDescriptorSetLayout(&descriptorSetLayoutCreateInfo, nullptr, &m_setLayout, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BatchRenderer::createDescriptors()");
+    }
+
+    vk::DescriptorPoolSize const poolSize { .type = vk::DescriptorType::eStorageBuffer, .descriptorCount = static_cast<uint32_t>(bindings.size()) };
+
+    vk::DescriptorPoolCreateInfo const descriptorPoolCreateInfo
+    {
+        .sType = vk::StructureType::eDescriptorPoolCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .maxSets = 1,
+        .poolSizeCount = 1,
+        .pPoolSizes = &poolSize
+    };
+
+    result = m_device.createDescriptorPool(&descriptorPoolCreateInfo, nullptr, &m_descriptorPool, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BatchRenderer::createDescriptors()");
+    }
+
+    vk::DescriptorSetAllocateInfo const descriptorSetAllocateInfo
+    {
+        .sType = vk::StructureType::eDescriptorSetAllocateInfo,
+        .pNext = {},
+        .descriptorPool = m_descriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &m_setLayout
+    };
+
+    result = m_device.allocateDescriptorSets(&descriptorSetAllocateInfo, &m_set, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BatchRenderer::createDescriptors()");
+    }
+
+    std::vector<vk::DescriptorBufferInfo> bufferInfos(bindings.size());
+    std::vector<vk::WriteDescriptorSet> writes(bindings.size());
+    for(size_t index = 0; index < bindings.size(); index++) {
+        bufferInfos[index] = vk::DescriptorBufferInfo { .buffer = m_buffers[bindings[index].binding].buffer, .offset = 0, .range = VK_WHOLE_SIZE };
+        writes[index] = vk::WriteDescriptorSet
+        {
+            .sType = vk::StructureType::eWriteDescriptorSet,
+            .pNext = {},
+            .dstSet = m_set,
+            .dstBinding = bindings[index].binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pImageInfo = {},
+            .pBufferInfo = &bufferInfos[index],
+            .pTexelBufferView = {}
+        };
+    }
+
+    m_device.updateDescriptorSets(static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr, loader);
+}
+
+void BatchRenderer::createPipelines(Shaders const& shaders, vk::RenderPass renderPass, vk::Format colorFormat, vk::PipelineCache cache, vk::DispatchLoaderDynamic const& loader) {
+
+    std::array const cullStages { &shaders.cull };
+    std::array const drawStages { &shaders.vertex, &shaders.fragment };
+    vk::PushConstantRange const cullRange = EmbeddedShader::pushConstantRange(cullStages);
+    vk::PushConstantRange const drawRange = EmbeddedShader::pushConstantRange(drawStages);
+
+    if(cullRange.size != sizeof(CullConstants) || drawRange.size != sizeof(m_viewProjection) || shaders.cull.localSize[0] != WorkgroupSize) {
+        throw std::runtime_error("Error: BatchRenderer::createPipelines() shader interface mismatch");
+    }
+
+    vk::PipelineLayoutCreateInfo cullLayoutCreateInfo
+    {
+        .sType = vk::StructureType::ePipelineLayoutCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .setLayoutCount = 1,
+        .pSetLayouts = &m_setLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &cullRange
+    };
+
+    vk::Result result = m_device.createPipelineLayout(&cullLayoutCreateInfo, nullptr, &m_cullLayout, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BatchRenderer::createPipelines()");
+    }
+
+    vk::PipelineLayoutCreateInfo drawLayoutCreateInfo = cullLayoutCreateInfo;
+    drawLayoutCreateInfo.setPPushConstantRanges(&drawRange);
+
+    result = m_device.createPipelineLayout(&drawLayoutCreateInfo, nullptr, &m_drawLayout, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BatchRenderer::createPipelines()");
+    }
+
+    vk::ShaderModule const cullModule = createShaderModule(shaders.cull.code, loader);
+
+    vk::ComputePipelineCreateInfo const computePipelineCreateInfo
+    {
+        .sType = vk::StructureType::eComputePipelineCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .stage = 
+        {
+            .sType = vk::StructureType::ePipelineShaderStageCreateInfo,
+            .pNext = {},
+            .flags = {},
+            .stage = vk::ShaderStageFlagBits::eCompute,
+            .module = cullModule,
+            .pName = "main",
+            .pSpecializationInfo = {}
+        },
+        .layout = m_cullLayout,
+        .basePipelineHandle = {},
+        .basePipelineIndex = -1
+    };
+
+    result = m_device.createComputePipelines(cache, 1, &computePipelineCreateInfo, nullptr, &m_cullPipeline, loader);
+    m_device.destroyShaderModule(cullModule, nullptr, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BatchRenderer::createPipelines()");
+    }
+
+    m_drawPipeline = createDrawPipeline(renderPass, colorFormat, loader);
+}
+
+vk::Pipeline BatchRenderer::createDrawPipeline(vk::RenderPass renderPass, vk::Format colorFormat, vk::DispatchLoaderDynamic const& loader) const {
+
+    vk::ShaderModule const vertexModule = createShaderModule(m_shaders.vertex.code, loader);
+    vk::ShaderModule const fragmentModule = createShaderModule(m_shaders.fragment.code, loader);
+
+    std::array const stages
+    {
+        vk::PipelineShaderStageCreateInfo
+        {
+            .sType = vk::StructureType::ePipelineShaderStageCreateInfo,
+            .pNext = {},
+            .flags = {},
+            .stage = vk::ShaderStageFlagBits::eVertex,
+            .module = vertexModule,
+            .pName = "main",
+            .pSpecializationInfo = {}
+        },
+        vk::PipelineShaderStageCreateInfo
+        {
+            .sType = vk::StructureType::ePipelineShaderStageCreateInfo,
+            .pNext = {},
+            .flags = {},
+            .stage = vk::ShaderStageFlagBits::eFragment,
+            .module = fragmentModule,
+            .pName = "main",
+            .pSpecializationInfo = {}
+        }
+    };
+
+    vk::VertexInputBindingDescription const vertexBinding { .binding = 0, .stride = sizeof(BatchVertex), .inputRate = vk::VertexInputRate::eVertex };
+    std::array const vertexAttributes
+    {
+        vk::VertexInputAttributeDescription { .location = 0, .binding = 0, .format = vk::Format::eR32G32B32Sfloat, .offset = offsetof(BatchVertex, position) },
+        vk::VertexInputAttributeDescription { .location = 1, .binding = 0, .format = vk::Format::eR32G32B32Sfloat, .offset = offsetof(BatchVertex, normal) }
+    };
+
+    vk::PipelineVertexInputStateCreateInfo const vertexInputState
+    {
+        .sType = vk::StructureType::ePipelineVertexInputStateCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .vertexBindingDescriptionCount = 1,
+        .pVertexBindingDescriptions = &vertexBinding,
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexAttributes.size()),
+        .pVertexAttributeDescriptions = vertexAttributes.data()
+    };
+
+    vk::PipelineInputAssemblyStateCreateInfo const inputAssemblyState
+    {
+        .sType = vk::StructureType::ePipelineInputAssemblyStateCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .topology = vk::PrimitiveTopology::eTriangleList,
+        .primitiveRestartEnable = vk::False
+    };
+
+    vk::PipelineViewportStateCreateInfo const viewportState
+    {
+        .sType = vk::StructureType::ePipelineViewportStateCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .viewportCount = 1,
+        .pViewports = {},
+        .scissorCount = 1,
+        .pScissors = {}
+    };
+
+    vk::PipelineRasterizationStateCreateInfo const rasterizationState
+    {
+        .sType = vk::StructureType::ePipelineRasterizationStateCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .depthClampEnable = vk::False,
+        .rasterizerDiscardEnable = vk::False,
+        .polygonMode = vk::PolygonMode::eFill,
+        .cullMode = vk::CullModeFlagBits::eBack,
+        .frontFace = vk::FrontFace::eCounterClockwise,
+        .depthBiasEnable = vk::False,
+        .depthBiasConstantFactor = 0.0f,
+        .depthBiasClamp = 0.0f,
+        .depthBiasSlopeFactor = 0.0f,
+        .lineWidth = 1.0f
+    };
+
+    vk::PipelineMultisampleStateCreateInfo const multisampleState
+    {
+        .sType = vk::StructureType::ePipelineMultisampleStateCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .rasterizationSamples = vk::SampleCountFlagBits::e1,
+        .sampleShadingEnable = vk::False,
+        .minSampleShading = 0.0f,
+        .pSampleMask = {},
+        .alphaToCoverageEnable = vk::False,
+        .alphaToOneEnable = vk::False
+    };
+
+    vk::PipelineColorBlendAttachmentState const colorBlendAttachment
+    {
+        .blendEnable = vk::False,
+        .srcColorBlendFactor = vk::BlendFactor::eOne,
+        .dstColorBlendFactor = vk::BlendFactor::eZero,
+        .colorBlendOp = vk::BlendOp::eAdd,
+        .srcAlphaBlendFactor = vk::BlendFactor::eOne,
+        .dstAlphaBlendFactor = vk::BlendFactor::eZero,
+        .alphaBlendOp = vk::BlendOp::eAdd,
+        .colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
+    };
+
+    vk::PipelineColorBlendStateCreateInfo const colorBlendState
+    {
+        .sType = vk::StructureType::ePipelineColorBlendStateCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .logicOpEnable = vk::False,
+        .logicOp = vk::LogicOp::eCopy,
+        .attachmentCount = 1,
+        .pAttachments = &colorBlendAttachment,
+        .blendConstants = {}
+    };
+
+    std::array const dynamicStates { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
+
+    vk::PipelineDynamicStateCreateInfo const dynamicState
+    {
+        .sType = vk::StructureType::ePipelineDynamicStateCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+        .pDynamicStates = dynamicStates.data()
+    };
+
+    vk::PipelineRenderingCreateInfo const renderingCreateInfo
+    {
+        .sType = vk::StructureType::ePipelineRenderingCreateInfo,
+        .pNext = {},
+        .viewMask = 0,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &colorFormat,
+        .depthAttachmentFormat = vk::Format::eUndefined,
+        .stencilAttachmentFormat = vk::Format::eUndefined
+    };
+
+    vk::GraphicsPipelineCreateInfo const graphicsPipelineCreateInfo
+    {
+        .sType = vk::StructureType::eGraphicsPipelineCreateInfo,
+        .pNext = renderPass ? nullptr : &renderingCreateInfo,
+        .flags = {},
+        .stageCount = static_cast<uint32_t>(stages.size()),
+        .pStages = stages.data(),
+        .pVertexInputState = &vertexInputState,
+        .pInputAssemblyState = &inputAssemblyState,
+        .pTessellationState = {},
+        .pViewportState = &viewportState,
+        .pRasterizationState = &rasterizationState,
+        .pMultisampleState = &multisampleState,
+        .pDepthStencilState = {},
+        .pColorBlendState = &colorBlendState,
+        .pDynamicState = &dynamicState,
+        .layout = m_drawLayout,
+        .renderPass = renderPass,
+        .subpass = 0,
+        .basePipelineHandle = {},
+        .basePipelineIndex = -1
+    };
+
+    vk::Pipeline pipeline {};
+    vk::Result const result = m_device.createGraphicsPipelines(m_cache, 1, &graphicsPipelineCreateInfo, nullptr, &pipeline, loader);
+
+    m_device.destroyShaderModule(vertexModule, nullptr, loader);
+    m_device.destroyShaderModule(fragmentModule, nullptr, loader);
+
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BatchRenderer::createDrawPipeline()");
+    }
+
+    return pipeline;
+}
+
+vk::Pipeline BatchRenderer::setTarget(vk::RenderPass renderPass, vk::Format colorFormat, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::Pipeline const pipeline = createDrawPipeline(renderPass, colorFormat, loader);
+    return std::exchange(m_drawPipeline, pipeline);
+}
+
+void BatchRenderer::destroy(vk::DispatchLoaderDynamic const& loader) {
+
+    if(!m_device) {
+        return;
+    }
+
+    if(m_drawPipeline) m_device.destroyPipeline(m_drawPipeline, nullptr, loader);
+    if(m_cullPipeline) m_device.destroyPipeline(m_cullPipeline, nullptr, loader);
+    if(m_drawLayout) m_device.destroyPipelineLayout(m_drawLayout, nullptr, loader);
+    if(m_cullLayout) m_device.destroyPipelineLayout(m_cullLayout, nullptr, loader);
+    if(m_descriptorPool) m_device.destroyDescriptorPool(m_descriptorPool, nullptr, loader);
+    if(m_setLayout) m_device.destroyDescriptorSetLayout(m_setLayout, nullptr, loader);
+
+    for(auto& buffer : m_buffers) {
+        if(buffer.buffer) m_device.destroyBuffer(buffer.buffer, nullptr, loader);
+        if(buffer.allocation.memory) m_allocator->free(buffer.allocation, loader);
+        buffer = Buffer {};
+    }
+
+    m_device = vk::Device {};
+}
+
+uint32_t BatchRenderer::addMesh(std::span<BatchVertex const> vertices, std::span<std::span<uint32_t const> const> lodIndices, float radius) {
+
+    if(lodIndices.empty() || lodIndices.size() > MaxLods) {
+        throw std::runtime_error("Error: BatchRenderer::addMesh() unsupported LOD count");
+    }
+
+    vk::DeviceSize indexCount = 0;
+    for(auto const& indices : lodIndices) {
+        indexCount += indices.size();
+    }
+
+    if(m_meshCount == m_meshCapacity
+        || (m_vertexCount + vertices.size()) * sizeof(BatchVertex) > m_buffers[eVertices].size
+        || (m_indexCount + indexCount) * sizeof(uint32_t) > m_buffers[eIndices].size) {
+        throw std::runtime_error("Error: BatchRenderer::addMesh() out of capacity");
+    }
+
+    Mesh mesh { .radius = radius, .lodCount = static_cast<uint32_t>(lodIndices.size()) };
+
+    for(uint32_t lod = 0; lod < lodIndices.size(); lod++) {
+        auto const indices = lodIndices[lod];
+        mesh.lods[lod] = MeshLod { .firstIndex = m_indexCount, .indexCount = static_cast<uint32_t>(indices.size()), .vertexOffset = static_cast<int32_t>(m_vertexCount) };
+        update(eIndices, sizeof(uint32_t) * m_indexCount, indices.data(), indices.size_bytes());
+        m_indexCount += static_cast<uint32_t>(indices.size());
+    }
+
+    update(eVertices, sizeof(BatchVertex) * m_vertexCount, vertices.data(), vertices.size_bytes());
+    m_vertexCount += static_cast<uint32_t>(vertices.size());
+
+    update(eMeshes, sizeof(Mesh) * m_meshCount, &mesh, sizeof(mesh));
+    return m_meshCount++;
+}
+
+uint32_t BatchRenderer::addInstance(BatchInstance const& instance) {
+
+    uint32_t index;
+    if(!m_freeInstances.empty()) {
+        index = m_freeInstances.back();
+        m_freeInstances.pop_back();
+    } else if(m_instanceCount < m_instanceCapacity) {
+        index = m_instanceCount++;
+    } else {
+        throw std::runtime_error("Error: BatchRenderer::addInstance() out of capacity");
+    }
+
+    setInstance(index, instance);
+    return index;
+}
+
+void BatchRenderer::setInstance(uint32_t index, BatchInstance const& instance) {
+
+    std::array const position { instance.position[0], instance.position[1], instance.position[2], instance.scale };
+
+    update(ePositions, sizeof(position) * index, position.data(), sizeof(position));
+    update(eOrientations, sizeof(instance.orientation) * index, instance.orientation.data(), sizeof(instance.orientation));
+    update(eMeshIndices, sizeof(uint32_t) * index, &instance.mesh, sizeof(uint32_t));
+}
+
+void BatchRenderer::removeInstance(uint32_t index) {
+
+    uint32_t const mesh = InvalidMesh;
+    update(eMeshIndices, sizeof(uint32_t) * index, &mesh, sizeof(uint32_t));
+    m_freeInstances.push_back(index);
+}
+
+void BatchRenderer::update(BufferIndex index, vk::DeviceSize offset, void const* data, vk::DeviceSize size) {
+
+    if(size == 0) {
+        return;
+    }
+
+    std::size_t const position = m_updateData.size();
+    m_updateData.resize(position + size);
+    std::memcpy(m_updateData.data() + position, data, size);
+    m_updates.push_back(PendingUpdate { .buffer = index, .offset = offset, .size = size, .data = position });
+}
+
+// Runs after the execution barrier at the top of cull(), so frames earlier
+// on the graphics queue have finished reading the ranges that are written.
+void BatchRenderer::recordUpdates(vk::CommandBuffer commandBuffer, vk::DispatchLoaderDynamic const& loader) {
+
+    // vkCmdUpdateBuffer takes at most 64 KiB per command.
+    constexpr vk::DeviceSize MaxUpdateSize = 65536;
+
+    for(PendingUpdate const& update : m_updates) {
+        for(vk::DeviceSize done = 0; done < update.size; done += MaxUpdateSize) {
+            vk::DeviceSize const size = std::min(update.size - done, MaxUpdateSize);
+            commandBuffer.updateBuffer(m_buffers[update.buffer].buffer, update.offset + done, size, m_updateData.data() + update.data + done, loader);
+        }
+    }
+
+    m_updates.clear();
+    m_updateData.clear();
+}
+
+void BatchRenderer::setCamera(std::array<float, 16> const& viewProjection, std::array<float, 3> const& position, float lodDistance) {
+
+    m_viewProjection = viewProjection;
+
+    auto const row = [&viewProjection](uint32_t index) {
+        return std::array { viewProjection[index], viewProjection[4 + index], viewProjection[8 + index], viewProjection[12 + index] };
+    };
+
+    auto const combine = [](std::array<float, 4> const& a, std::array<float, 4> const& b, float sign) {
+        std::array<float, 4> plane { a[0] + sign * b[0], a[1] + sign * b[1], a[2] + sign * b[2], a[3] + sign * b[3] };
+        float const length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        for(auto& value : plane) value /= length;
+        return plane;
+    };
+
+    std::array<float, 4> const x = row(0);
+    std::array<float, 4> const y = row(1);
+    std::array<float, 4> const z = row(2);
+    std::array<float, 4> const w = row(3);
+
+    m_cullConstants.planes = { combine(w, x, 1.0f), combine(w, x, -1.0f), combine(w, y, 1.0f), combine(w, y, -1.0f), combine(z, z, 0.0f), combine(w, z, -1.0f) };
+    m_cullConstants.camera = { position[0], position[1], position[2], std::max(lodDistance, 1e-3f) };
+}
+
+void BatchRenderer::cull(vk::CommandBuffer commandBuffer, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::PipelineStageFlags const readStages = vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eComputeShader;
+
+    commandBuffer.pipelineBarrier(readStages, vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader, {}, 0, nullptr, 0, nullptr, 0, nullptr, loader);
+    recordUpdates(commandBuffer, loader);
+    commandBuffer.fillBuffer(m_buffers[eDrawCount].buffer, 0, sizeof(uint32_t), 0, loader);
+
+    vk::MemoryBarrier const transferBarrier
+    {
+        .sType = vk::StructureType::eMemoryBarrier,
+        .pNext = {},
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead
+    };
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader, {}, 1, &transferBarrier, 0, nullptr, 0, nullptr, loader);
+
+    if(m_instanceCount != 0) {
+        CullConstants constants = m_cullConstants;
+        constants.instanceCount = m_instanceCount;
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_cullPipeline, loader);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_cullLayout, 0, 1, &m_set, 0, nullptr, loader);
+        commandBuffer.pushConstants(m_cullLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(constants), &constants, loader);
+        commandBuffer.dispatch((m_instanceCount + WorkgroupSize - 1) / WorkgroupSize, 1, 1, loader);
+    }
+
+    vk::MemoryBarrier const cullBarrier
+    {
+        .sType = vk::StructureType::eMemoryBarrier,
+        .pNext = {},
+        .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+        .dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead
+    };
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect, {}, 1, &cullBarrier, 0, nullptr, 0, nullptr, loader);
+}
+
+void BatchRenderer::draw(vk::CommandBuffer commandBuffer, vk::Extent2D extent, vk::DispatchLoaderDynamic const& loader) const {
+
+    if(m_instanceCount == 0) {
+        return;
+    }
+
+    vk::Viewport const viewport { .x = 0.0f, .y = 0.0f, .width = static_cast<float>(extent.width), .height = static_cast<float>(extent.height), .minDepth = 0.0f, .maxDepth = 1.0f };
+    vk::Rect2D const scissor { .offset = {0, 0}, .extent = extent };
+    vk::DeviceSize const vertexOffset = 0;
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_drawPipeline, loader);
+    commandBuffer.setViewport(0, 1, &viewport, loader);
+    commandBuffer.setScissor(0, 1, &scissor, loader);
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_drawLayout, 0, 1, &m_set, 0, nullptr, loader);
+    commandBuffer.pushConstants(m_drawLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(m_viewProjection), m_viewProjection.data(), loader);
+    commandBuffer.bindVertexBuffers(0, 1, &m_buffers[eVertices].buffer, &vertexOffset, loader);
+    commandBuffer.bindIndexBuffer(m_buffers[eIndices].buffer, 0, vk::IndexType::eUint32, loader);
+    commandBuffer.drawIndexedIndirectCount(m_buffers[eDraws].buffer, 0, m_buffers[eDrawCount].buffer, 0, m_instanceCount, sizeof(vk::DrawIndexedIndirectCommand), loader);
+}
+
+uint32_t BatchRenderer::instanceCount() const {
+    return m_instanceCount;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "allocator.hpp"
+#include "shader.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+struct BatchVertex {
+    std::array<float, 3>                position        {};
+    std::array<float, 3>                normal          {};
+};
+
+struct BatchInstance {
+    std::array<float, 3>                position        {};
+    float                               scale           {1.0f};
+    std::array<float, 4>                orientation     {0.0f, 0.0f, 0.0f, 1.0f};
+    uint32_t                            mesh            {};
+};
+
+// Draws every instance with one vkCmdDrawIndexedIndirectCount. Instance data
+// lives in structure-of-arrays storage buffers; cull() runs frustum culling
+// and LOD selection in a compute shader that appends one
+// VkDrawIndexedIndirectCommand per visible instance, so CPU cost does not grow
+// with the scene. Descriptor and push constant layouts come from the
+// reflection of the embedded shaders/ modules. Mesh and instance writes are
+// queued and recorded on the graphics queue at the start of cull(), after the
+// frames in flight that read the same ranges.
+class BatchRenderer final {
+
+    public:
+        static constexpr uint32_t MaxLods = 4;
+        static constexpr uint32_t WorkgroupSize = 64;
+        static constexpr uint32_t InvalidMesh = UINT32_MAX;
+
+        struct Shaders {
+            EmbeddedShader              cull            {};
+            EmbeddedShader              vertex          {};
+            EmbeddedShader              fragment        {};
+        };
+
+    private:
+        struct MeshLod {
+            uint32_t                    firstIndex      {};
+            uint32_t                    indexCount      {};
+            int32_t                     vertexOffset    {};
+        };
+
+        struct Mesh {
+            float                               radius          {};
+            uint32_t                            lodCount        {};
+            uint32_t                            padding0        {};
+            uint32_t                            padding1        {};
+            std::array<MeshLod, MaxLods>        lods            {};
+        };
+
+        struct CullConstants {
+            std::array<std::array<float, 4>, 6> planes          {};
+            std::array<float, 4>                camera          {};
+            uint32_t                            instanceCount   {};
+        };
+
+        struct Buffer {
+            vk::Buffer                  buffer          {};
+            Allocation                  allocation      {};
+            vk::DeviceSize              size            {};
+        };
+
+        enum BufferIndex : uint32_t {
+            ePositions,
+            eOrientations,
+            eMeshIndices,
+            eMeshes,
+            eDraws,
+            eDrawCount,
+            eVertices,
+            eIndices,
+            eBufferCount
+        };
+
+        // A write waiting for the next cull(); data indexes m_updateData.
+        struct PendingUpdate {
+            BufferIndex                 buffer          {};
+            vk::DeviceSize              offset          {};
+            vk::DeviceSize              size            {};
+            std::size_t                 data            {};
+        };
+
+    private:
+        vk::Device                              m_device                {};
+        Allocator*                              m_allocator             {};
+        std::array<Buffer, eBufferCount>        m_buffers               {};
+        vk::DescriptorSetLayout                 m_setLayout             {};
+        vk::DescriptorPool                      m_descriptorPool        {};
+        vk::DescriptorSet                       m_set                   {};
+        vk::PipelineLayout                      m_cullLayout            {};
+        vk::PipelineLayout                      m_drawLayout            {};
+        vk::Pipeline                            m_cullPipeline          {};
+        vk::Pipeline                            m_drawPipeline          {};
+        Shaders                                 m_shaders               {};
+        vk::PipelineCache                       m_cache                 {};
+        uint32_t                                m_instanceCapacity      {};
+        uint32_t                                m_meshCapacity          {};
+        uint32_t                                m_instanceCount         {};
+        uint32_t                                m_meshCount             {};
+        uint32_t                                m_vertexCount           {};
+        uint32_t                                m_indexCount            {};
+        std::vector<uint32_t>                   m_freeInstances         {};
+        std::vector<PendingUpdate>              m_updates               {};
+        std::vector<std::byte>                  m_updateData            {};
+        CullConstants                           m_cullConstants         {};
+        std::array<float, 16>                   m_viewProjection        {};
+
+    private:
+        void createBuffer(BufferIndex index, vk::DeviceSize size, vk::BufferUsageFlags usage, vk::DispatchLoaderDynamic const& loader);
+        vk::ShaderModule createShaderModule(std::span<uint32_t const> code, vk::DispatchLoaderDynamic const& loader) const;
+        void createDescriptors(Shaders const& shaders, vk::DispatchLoaderDynamic const& loader);
+        void createPipelines(Shaders const& shaders, vk::RenderPass renderPass, vk::Format colorFormat, vk::PipelineCache cache, vk::DispatchLoaderDynamic const& loader);
+        void update(BufferIndex index, vk::DeviceSize offset, void const* data, vk::DeviceSize size);
+        void recordUpdates(vk::CommandBuffer commandBuffer, vk::DispatchLoaderDynamic const& loader);
+        vk::Pipeline createDrawPipeline(vk::RenderPass renderPass, vk::Format colorFormat, vk::DispatchLoaderDynamic const& loader) const;
+
+    public:
+        void create(vk::Device device, Allocator& allocator, Shaders const& shaders, vk::RenderPass renderPass, vk::Format colorFormat, vk::PipelineCache cache, vk::DispatchLoaderDynamic const& loader,
+            uint32_t instanceCapacity = 1u << 18, uint32_t meshCapacity = 1024, uint32_t vertexCapacity = 1u << 20, uint32_t indexCapacity = 1u << 22);
+        void destroy(vk::DispatchLoaderDynamic const& loader);
+
+        // Rebuilds the draw pipeline for a new render pass or color format and
+        // returns the previous one, which frames in flight may still use.
+        vk::Pipeline setTarget(vk::RenderPass renderPass, vk::Format colorFormat, vk::DispatchLoaderDynamic const& loader);
+
+        uint32_t addMesh(std::span<BatchVertex const> vertices, std::span<std::span<uint32_t const> const> lodIndices, float radius);
+        uint32_t addInstance(BatchInstance const& instance);
+        void setInstance(uint32_t index, BatchInstance const& instance);
+        void removeInstance(uint32_t index);
+
+        void setCamera(std::array<float, 16> const& viewProjection, std::array<float, 3> const& position, float lodDistance);
+
+        void cull(vk::CommandBuffer commandBuffer, vk::DispatchLoaderDynamic const& loader);
+        void draw(vk::CommandBuffer commandBuffer, vk::Extent2D extent, vk::DispatchLoaderDynamic const& loader) const;
+
+        uint32_t instanceCount() const;
+};
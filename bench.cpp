@@ -0,0 +1,99 @@
+#include "window.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+
+    uint32_t const frameCount = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 1000;
+    uint32_t const warmupCount = 16;
+
+    if(frameCount == 0) {
+        std::cerr << "Error: frame count must be at least 1" << std::endl;
+        return 1;
+    }
+
+    auto window = Window::createHeadlessWindow(1280, 720);
+
+    window.setClearColor(1, 0, 0);
+
+    for(uint32_t x=0; x<warmupCount; x++) {
+        window.update();
+    }
+    window.waitIdle();
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(frameCount);
+
+    bool const profile = argc > 3;
+    if(profile) {
+        Profiler::instance().beginCapture();
+    }
+
+    bool const capture = argc > 4;
+    if(capture) {
+        window.startCapture(FrameCapture::imageSequence(argv[4]));
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for(uint32_t x=0; x<frameCount; x++) {
+        auto const frameStart = std::chrono::steady_clock::now();
+        window.update();
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+    }
+    window.waitIdle();
+
+    if(profile) {
+        Profiler::instance().endCapture();
+    }
+
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ranges::sort(frameTimes);
+    auto const percentile = [&frameTimes](double p) {
+        return frameTimes[std::min(frameTimes.size() - 1, static_cast<std::size_t>(p * frameTimes.size()))];
+    };
+
+    std::cout << "frames:     " << frameCount << std::endl;
+    std::cout << "frames/sec: " << frameCount / seconds << std::endl;
+    std::cout << "p50 ms:     " << percentile(0.50) << std::endl;
+    std::cout << "p99 ms:     " << percentile(0.99) << std::endl;
+
+    if(capture) {
+        std::cout << "captured:   " << window.getFrameCapture().captured() << std::endl;
+        std::cout << "dropped:    " << window.getFrameCapture().dropped() << std::endl;
+        window.stopCapture();
+    }
+
+    auto const timings = window.getFrameTimer().snapshot();
+    if(timings.empty()) {
+        return 0;
+    }
+
+    std::array<double, FramePhaseCount> phaseTimes {};
+    double gpuTime = 0;
+    for(auto const& timing : timings) {
+        for(std::size_t x=0; x<FramePhaseCount; x++) {
+            phaseTimes[x] += timing.cpuTime(static_cast<FramePhase>(x));
+        }
+        gpuTime += timing.gpuTime / 1e6;
+    }
+
+    for(std::size_t x=0; x<FramePhaseCount; x++) {
+        std::cout << FrameTimer::phaseName(static_cast<FramePhase>(x)) << " ms: " << phaseTimes[x] / timings.size() << std::endl;
+    }
+    std::cout << "gpu ms: " << gpuTime / timings.size() << std::endl;
+
+    if(argc > 2) {
+        std::ofstream trace(argv[2]);
+        window.getFrameTimer().writeChromeTrace(trace);
+    }
+
+    if(profile) {
+        std::ofstream trace(argv[3]);
+        Profiler::instance().writeChromeTrace(trace);
+    }
+}
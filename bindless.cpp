@@ -0,0 +1,280 @@
+#include "bindless.hpp"
+
+#include <algorithm>
+
+namespace {
+    constexpr vk::DescriptorType descriptorType(BindlessKind kind) {
+        switch(kind) {
+            case BindlessKind::eSampledImage:   return vk::DescriptorType::eSampledImage;
+            case BindlessKind::eSampler:        return vk::DescriptorType::eSampler;
+            case BindlessKind::eStorageBuffer:  return vk::DescriptorType::eStorageBuffer;
+            default:                            return vk::DescriptorType::eSampler;
+        }
+    }
+}
+
+bool BindlessTable::supported(vk::PhysicalDeviceVulkan12Features const& features) {
+    return features.descriptorIndexing
+        && features.runtimeDescriptorArray
+        && features.descriptorBindingPartiallyBound
+        && features.descriptorBindingUpdateUnusedWhilePending
+        && features.descriptorBindingSampledImageUpdateAfterBind
+        && features.descriptorBindingStorageBufferUpdateAfterBind
+        && features.shaderSampledImageArrayNonUniformIndexing
+        && features.shaderStorageBufferArrayNonUniformIndexing;
+}
+
+void BindlessTable::enable(vk::PhysicalDeviceVulkan12Features& features) {
+    features.setDescriptorIndexing(vk::True);
+    features.setRuntimeDescriptorArray(vk::True);
+    features.setDescriptorBindingPartiallyBound(vk::True);
+    features.setDescriptorBindingUpdateUnusedWhilePending(vk::True);
+    features.setDescriptorBindingSampledImageUpdateAfterBind(vk::True);
+    features.setDescriptorBindingStorageBufferUpdateAfterBind(vk::True);
+    features.setShaderSampledImageArrayNonUniformIndexing(vk::True);
+    features.setShaderStorageBufferArrayNonUniformIndexing(vk::True);
+}
+
+void BindlessTable::create(vk::PhysicalDevice physicalDevice, vk::Device device, vk::DispatchLoaderDynamic const& loader, uint32_t sampledImages, uint32_t samplers, uint32_t storageBuffers) {
+
+    m_device = device;
+
+    vk::PhysicalDeviceVulkan12Properties vulkan12Properties { .sType = vk::StructureType::ePhysicalDeviceVulkan12Properties };
+
+    vk::PhysicalDeviceProperties2 properties
+    {
+        .sType = vk::StructureType::ePhysicalDeviceProperties2,
+        .pNext = &vulkan12Properties,
+        .properties = {}
+    };
+    physicalDevice.getProperties2(&properties, loader);
+
+    m_slots[static_cast<std::size_t>(BindlessKind::eSampledImage)].capacity = std::min({ sampledImages,
+        vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages, vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages });
+    m_slots[static_cast<std::size_t>(BindlessKind::eSampler)].capacity = std::min({ samplers,
+        vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers, vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers });
+    m_slots[static_cast<std::size_t>(BindlessKind::eStorageBuffer)].capacity = std::min({ storageBuffers,
+        vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageBuffers, vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+    m_pushConstantSize = std::min(PushConstantSize, properties.properties.limits.maxPushConstantsSize);
+
+    std::array<vk::DescriptorSetLayoutBinding, BindlessKindCount> bindings {};
+    std::array<vk::DescriptorBindingFlags, BindlessKindCount> bindingFlags {};
+    std::array<vk::DescriptorPoolSize, BindlessKindCount> poolSizes {};
+
+    for(uint32_t binding = 0; binding < BindlessKindCount; binding++) {
+        auto const kind = static_cast<BindlessKind>(binding);
+        bindings[binding] = vk::DescriptorSetLayoutBinding
+        {
+            .binding = binding,
+            .descriptorType = descriptorType(kind),
+            .descriptorCount = m_slots[binding].capacity,
+            .stageFlags = vk::ShaderStageFlagBits::eAll,
+            .pImmutableSamplers = {}
+        };
+        bindingFlags[binding] = vk::DescriptorBindingFlagBits::eUpdateAfterBind | vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+        poolSizes[binding] = vk::DescriptorPoolSize { .type = descriptorType(kind), .descriptorCount = m_slots[binding].capacity };
+    }
+
+    vk::DescriptorSetLayoutBindingFlagsCreateInfo const bindingFlagsCreateInfo
+    {
+        .sType = vk::StructureType::eDescriptorSetLayoutBindingFlagsCreateInfo,
+        .pNext = {},
+        .bindingCount = static_cast<uint32_t>(bindingFlags.size()),
+        .pBindingFlags = bindingFlags.data()
+    };
+
+    vk::DescriptorSetLayoutCreateInfo const descriptorSetLayoutCreateInfo
+    {
+        .sType = vk::StructureType::eDescriptorSetLayoutCreateInfo,
+        .pNext = &bindingFlagsCreateInfo,
+        .flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool,
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
+    };
+
+    vk::Result result = m_device.createDescriptorSetLayout(&descriptorSetLayoutCreateInfo, nullptr, &m_setLayout, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BindlessTable::create()");
+    }
+
+    vk::DescriptorPoolCreateInfo const descriptorPoolCreateInfo
+    {
+        .sType = vk::StructureType::eDescriptorPoolCreateInfo,
+        .pNext = {},
+        .flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind,
+        .maxSets = 1,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data()
+    };
+
+    result = m_device.createDescriptorPool(&descriptorPoolCreateInfo, nullptr, &m_pool, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BindlessTable::create()");
+    }
+
+    vk::DescriptorSetAllocateInfo const descriptorSetAllocateInfo
+    {
+        .sType = vk::StructureType::eDescriptorSetAllocateInfo,
+        .pNext = {},
+        .descriptorPool = m_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &m_setLayout
+    };
+
+    result = m_device.allocateDescriptorSets(&descriptorSetAllocateInfo, &m_set, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BindlessTable::create()");
+    }
+
+    vk::PushConstantRange const pushConstantRange
+    {
+        .stageFlags = vk::ShaderStageFlagBits::eAll,
+        .offset = 0,
+        .size = m_pushConstantSize
+    };
+
+    vk::PipelineLayoutCreateInfo const pipelineLayoutCreateInfo
+    {
+        .sType = vk::StructureType::ePipelineLayoutCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .setLayoutCount = 1,
+        .pSetLayouts = &m_setLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange
+    };
+
+    result = m_device.createPipelineLayout(&pipelineLayoutCreateInfo, nullptr, &m_pipelineLayout, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: BindlessTable::create()");
+    }
+}
+
+void BindlessTable::destroy(vk::DispatchLoaderDynamic const& loader) {
+
+    if(!m_device) {
+        return;
+    }
+
+    if(m_pipelineLayout) m_device.destroyPipelineLayout(m_pipelineLayout, nullptr, loader);
+    if(m_pool) m_device.destroyDescriptorPool(m_pool, nullptr, loader);
+    if(m_setLayout) m_device.destroyDescriptorSetLayout(m_setLayout, nullptr, loader);
+
+    m_pipelineLayout = vk::PipelineLayout {};
+    m_pool = vk::DescriptorPool {};
+    m_set = vk::DescriptorSet {};
+    m_setLayout = vk::DescriptorSetLayout {};
+    m_slots = {};
+    m_retired.clear();
+    m_device = vk::Device {};
+}
+
+uint32_t BindlessTable::allocate(BindlessKind kind) {
+
+    Slots& slots = m_slots[static_cast<std::size_t>(kind)];
+
+    if(!slots.freeList.empty()) {
+        uint32_t const index = slots.freeList.back();
+        slots.freeList.pop_back();
+        return index;
+    }
+
+    if(slots.next == slots.capacity) {
+        throw std::runtime_error("Error: BindlessTable::allocate() table is full");
+    }
+    return slots.next++;
+}
+
+void BindlessTable::write(BindlessKind kind, uint32_t index, vk::DescriptorImageInfo const* imageInfo, vk::DescriptorBufferInfo const* bufferInfo, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::WriteDescriptorSet const writeDescriptorSet
+    {
+        .sType = vk::StructureType::eWriteDescriptorSet,
+        .pNext = {},
+        .dstSet = m_set,
+        .dstBinding = static_cast<uint32_t>(kind),
+        .dstArrayElement = index,
+        .descriptorCount = 1,
+        .descriptorType = descriptorType(kind),
+        .pImageInfo = imageInfo,
+        .pBufferInfo = bufferInfo,
+        .pTexelBufferView = {}
+    };
+
+    m_device.updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr, loader);
+}
+
+uint32_t BindlessTable::addSampledImage(vk::ImageView imageView, vk::ImageLayout layout, vk::DispatchLoaderDynamic const& loader) {
+
+    std::lock_guard lock(m_mutex);
+
+    uint32_t const index = allocate(BindlessKind::eSampledImage);
+    vk::DescriptorImageInfo const imageInfo { .sampler = {}, .imageView = imageView, .imageLayout = layout };
+    write(BindlessKind::eSampledImage, index, &imageInfo, nullptr, loader);
+    return index;
+}
+
+uint32_t BindlessTable::addSampler(vk::Sampler sampler, vk::DispatchLoaderDynamic const& loader) {
+
+    std::lock_guard lock(m_mutex);
+
+    uint32_t const index = allocate(BindlessKind::eSampler);
+    vk::DescriptorImageInfo const imageInfo { .sampler = sampler, .imageView = {}, .imageLayout = vk::ImageLayout::eUndefined };
+    write(BindlessKind::eSampler, index, &imageInfo, nullptr, loader);
+    return index;
+}
+
+uint32_t BindlessTable::addStorageBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range, vk::DispatchLoaderDynamic const& loader) {
+
+    std::lock_guard lock(m_mutex);
+
+    uint32_t const index = allocate(BindlessKind::eStorageBuffer);
+    vk::DescriptorBufferInfo const bufferInfo { .buffer = buffer, .offset = offset, .range = range };
+    write(BindlessKind::eStorageBuffer, index, nullptr, &bufferInfo, loader);
+    return index;
+}
+
+void BindlessTable::release(BindlessKind kind, uint32_t index, uint64_t retireValue) {
+
+    if(index == InvalidIndex) {
+        return;
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_retired.push_back(Retired { .value = retireValue, .kind = kind, .index = index });
+}
+
+void BindlessTable::reclaim(uint64_t completedValue) {
+
+    std::lock_guard lock(m_mutex);
+
+    while(!m_retired.empty() && m_retired.front().value <= completedValue) {
+        Retired const& retired = m_retired.front();
+        m_slots[static_cast<std::size_t>(retired.kind)].freeList.push_back(retired.index);
+        m_retired.pop_front();
+    }
+}
+
+void BindlessTable::bind(vk::CommandBuffer commandBuffer, vk::PipelineBindPoint bindPoint, vk::DispatchLoaderDynamic const& loader) const {
+    commandBuffer.bindDescriptorSets(bindPoint, m_pipelineLayout, 0, 1, &m_set, 0, nullptr, loader);
+}
+
+void BindlessTable::pushIndices(vk::CommandBuffer commandBuffer, std::span<uint32_t const> indices, vk::DispatchLoaderDynamic const& loader, uint32_t offset) const {
+    commandBuffer.pushConstants(m_pipelineLayout, vk::ShaderStageFlagBits::eAll, offset, static_cast<uint32_t>(indices.size_bytes()), indices.data(), loader);
+}
+
+bool BindlessTable::valid() const {
+    return static_cast<bool>(m_set);
+}
+
+uint32_t BindlessTable::capacity(BindlessKind kind) const {
+    return m_slots[static_cast<std::size_t>(kind)].capacity;
+}
+
+vk::DescriptorSetLayout BindlessTable::setLayout() const {
+    return m_setLayout;
+}
+
+vk::PipelineLayout BindlessTable::pipelineLayout() const {
+    return m_pipelineLayout;
+}
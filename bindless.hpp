@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+// Binding index inside the bindless set. Shaders declare
+//   layout(set = 0, binding = 0) uniform texture2D textures[];
+//   layout(set = 0, binding = 1) uniform sampler samplers[];
+//   layout(set = 0, binding = 2) buffer Buffers { uint data[]; } buffers[];
+enum class BindlessKind : uint32_t {
+    eSampledImage,
+    eSampler,
+    eStorageBuffer,
+    eCount
+};
+
+constexpr std::size_t BindlessKindCount = static_cast<std::size_t>(BindlessKind::eCount);
+
+// One update-after-bind descriptor set holding every resource the renderer
+// uses. Draws refer to resources by a 32-bit index pushed as a push constant,
+// so the set is bound once per command buffer. Released indices are recycled
+// once the timeline value they were retired at has completed.
+class BindlessTable final {
+
+    public:
+        static constexpr uint32_t InvalidIndex = UINT32_MAX;
+        static constexpr uint32_t PushConstantSize = 128;
+
+    private:
+        struct Retired {
+            uint64_t                    value           {};
+            BindlessKind                kind            {};
+            uint32_t                    index           {};
+        };
+
+        struct Slots {
+            uint32_t                    capacity        {};
+            uint32_t                    next            {};
+            std::vector<uint32_t>       freeList        {};
+        };
+
+    private:
+        vk::Device                                      m_device                {};
+        vk::DescriptorSetLayout                         m_setLayout             {};
+        vk::DescriptorPool                              m_pool                  {};
+        vk::DescriptorSet                               m_set                   {};
+        vk::PipelineLayout                              m_pipelineLayout        {};
+        uint32_t                                        m_pushConstantSize      {};
+        std::array<Slots, BindlessKindCount>            m_slots                 {};
+        std::deque<Retired>                             m_retired               {};
+        std::mutex                                      m_mutex                 {};
+
+    private:
+        uint32_t allocate(BindlessKind kind);
+        void write(BindlessKind kind, uint32_t index, vk::DescriptorImageInfo const* imageInfo, vk::DescriptorBufferInfo const* bufferInfo, vk::DispatchLoaderDynamic const& loader);
+
+    public:
+        static bool supported(vk::PhysicalDeviceVulkan12Features const& features);
+        static void enable(vk::PhysicalDeviceVulkan12Features& features);
+
+        void create(vk::PhysicalDevice physicalDevice, vk::Device device, vk::DispatchLoaderDynamic const& loader, uint32_t sampledImages = 16384, uint32_t samplers = 1024, uint32_t storageBuffers = 16384);
+        void destroy(vk::DispatchLoaderDynamic const& loader);
+
+        uint32_t addSampledImage(vk::ImageView imageView, vk::ImageLayout layout, vk::DispatchLoaderDynamic const& loader);
+        uint32_t addSampler(vk::Sampler sampler, vk::DispatchLoaderDynamic const& loader);
+        uint32_t addStorageBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range, vk::DispatchLoaderDynamic const& loader);
+        void release(BindlessKind kind, uint32_t index, uint64_t retireValue);
+        void reclaim(uint64_t completedValue);
+
+        void bind(vk::CommandBuffer commandBuffer, vk::PipelineBindPoint bindPoint, vk::DispatchLoaderDynamic const& loader) const;
+        void pushIndices(vk::CommandBuffer commandBuffer, std::span<uint32_t const> indices, vk::DispatchLoaderDynamic const& loader, uint32_t offset = 0) const;
+
+        bool valid() const;
+        uint32_t capacity(BindlessKind kind) const;
+        vk::DescriptorSetLayout setLayout() const;
+        vk::PipelineLayout pipelineLayout() const;
+};
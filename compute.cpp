@@ -0,0 +1,131 @@
+#include "compute.hpp"
+
+void ComputeQueue::create(vk::Device device, vk::Queue queue, std::mutex& queueMutex, uint32_t queueFamilyIndex, vk::DispatchLoaderDynamic const& loader) {
+
+    m_device = device;
+    m_queue = queue;
+    m_queueMutex = &queueMutex;
+    m_queueFamilyIndex = queueFamilyIndex;
+
+    m_timeline.create(m_device, loader);
+
+    vk::CommandPoolCreateInfo const commandPoolCreateInfo 
+    {
+        .sType = vk::StructureType::eCommandPoolCreateInfo,
+        .pNext = {},
+        .flags = vk::CommandPoolCreateFlagBits::eTransient,
+        .queueFamilyIndex = m_queueFamilyIndex
+    };
+
+    for(auto& batch : m_batches) {
+        vk::Result result = m_device.createCommandPool(&commandPoolCreateInfo, nullptr, &batch.commandPool, loader);
+        if(result != vk::Result::eSuccess) {
+            throw std::runtime_error("Error: ComputeQueue::create()");
+        }
+
+        vk::CommandBufferAllocateInfo const commandBufferAllocateInfo 
+        {
+            .sType = vk::StructureType::eCommandBufferAllocateInfo,
+            .pNext = {},
+            .commandPool = batch.commandPool,
+            .level = vk::CommandBufferLevel::ePrimary,
+            .commandBufferCount = 1
+        };
+
+        result = m_device.allocateCommandBuffers(&commandBufferAllocateInfo, &batch.commandBuffer, loader);
+        if(result != vk::Result::eSuccess) {
+            throw std::runtime_error("Error: ComputeQueue::create()");
+        }
+    }
+}
+
+void ComputeQueue::destroy(vk::DispatchLoaderDynamic const& loader) {
+
+    if(!m_device) {
+        return;
+    }
+
+    m_timeline.wait(m_device, m_timeline.value(), loader);
+
+    for(auto& batch : m_batches) {
+        if(batch.commandPool) m_device.destroyCommandPool(batch.commandPool, nullptr, loader);
+        batch = Batch {};
+    }
+
+    m_timeline.destroy(m_device, loader);
+
+    m_device = vk::Device {};
+}
+
+uint64_t ComputeQueue::submit(Record const& record, vk::Semaphore waitSemaphore, uint64_t waitValue, vk::DispatchLoaderDynamic const& loader) {
+
+    Batch& batch = m_batches[m_batchIndex];
+
+    if(batch.value != 0) {
+        m_timeline.wait(m_device, batch.value, loader);
+    }
+    m_device.resetCommandPool(batch.commandPool, {}, loader);
+
+    vk::CommandBufferBeginInfo const commandBufferBeginInfo 
+    {
+        .sType = vk::StructureType::eCommandBufferBeginInfo,
+        .pNext = {},
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+        .pInheritanceInfo = {},
+    };
+
+    batch.commandBuffer.begin(commandBufferBeginInfo, loader);
+    record(batch.commandBuffer);
+    batch.commandBuffer.end(loader);
+
+    batch.value = m_timeline.next();
+
+    bool const wait = waitSemaphore && waitValue != 0;
+    vk::Semaphore const semaphore = m_timeline.semaphore();
+    vk::PipelineStageFlags const waitStage = vk::PipelineStageFlagBits::eComputeShader;
+
+    vk::TimelineSemaphoreSubmitInfo const timelineSemaphoreSubmitInfo
+    {
+        .sType = vk::StructureType::eTimelineSemaphoreSubmitInfo,
+        .pNext = {},
+        .waitSemaphoreValueCount = wait ? 1u : 0u,
+        .pWaitSemaphoreValues = &waitValue,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &batch.value
+    };
+
+    vk::SubmitInfo const submitInfo
+    {
+        .sType = vk::StructureType::eSubmitInfo,
+        .pNext = &timelineSemaphoreSubmitInfo,
+        .waitSemaphoreCount = wait ? 1u : 0u,
+        .pWaitSemaphores = &waitSemaphore,
+        .pWaitDstStageMask = &waitStage,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &batch.commandBuffer,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &semaphore,
+    };
+
+    {
+        std::scoped_lock lock(*m_queueMutex);
+        if(vk::Result result = m_queue.submit(1, &submitInfo, {}, loader); result != vk::Result::eSuccess) {
+            throw std::runtime_error("Error: ComputeQueue::submit()");
+        }
+    }
+
+    m_batchIndex = (m_batchIndex + 1) % BatchCount;
+    return batch.value;
+}
+
+uint32_t ComputeQueue::queueFamilyIndex() const {
+    return m_queueFamilyIndex;
+}
+
+Timeline& ComputeQueue::timeline() {
+    return m_timeline;
+}
+
+bool ComputeQueue::isComplete(uint64_t value, vk::DispatchLoaderDynamic const& loader) {
+    return m_timeline.isComplete(m_device, value, loader);
+}
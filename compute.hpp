@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+#include "timeline.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+// Runs compute work on its own queue so it can overlap with rasterization.
+// Every submission signals the compute timeline and may wait for a value of
+// another timeline first. Resources used by both queues need
+// vk::SharingMode::eConcurrent when the queue families differ. Submissions
+// lock queueMutex, which is shared with any other user of the same VkQueue.
+class ComputeQueue final {
+
+    public:
+        static constexpr uint32_t BatchCount = 8;
+
+        using Record = std::function<void(vk::CommandBuffer commandBuffer)>;
+
+    private:
+        struct Batch {
+            vk::CommandPool             commandPool     {};
+            vk::CommandBuffer           commandBuffer   {};
+            uint64_t                    value           {};
+        };
+
+    private:
+        vk::Device                          m_device                    {};
+        vk::Queue                           m_queue                     {};
+        std::mutex*                         m_queueMutex                {};
+        uint32_t                            m_queueFamilyIndex          {};
+        Timeline                            m_timeline                  {};
+        uint32_t                            m_batchIndex                {};
+        std::array<Batch, BatchCount>       m_batches                   {};
+
+    public:
+        void create(vk::Device device, vk::Queue queue, std::mutex& queueMutex, uint32_t queueFamilyIndex, vk::DispatchLoaderDynamic const& loader);
+        void destroy(vk::DispatchLoaderDynamic const& loader);
+
+        uint64_t submit(Record const& record, vk::Semaphore waitSemaphore, uint64_t waitValue, vk::DispatchLoaderDynamic const& loader);
+
+        uint32_t queueFamilyIndex() const;
+        Timeline& timeline();
+        bool isComplete(uint64_t value, vk::DispatchLoaderDynamic const& loader);
+};
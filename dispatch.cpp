@@ -0,0 +1,44 @@
+#include "dispatch.hpp"
+
+void DeviceDispatch::init(vk::Device device, PFN_vkGetDeviceProcAddr getDeviceProcAddr) {
+
+    VkDevice const handle = device;
+
+    auto const load = [handle, getDeviceProcAddr]<typename Function>(Function& function, char const* name, char const* fallback = nullptr) {
+        function = reinterpret_cast<Function>(getDeviceProcAddr(handle, name));
+        if(!function && fallback) {
+            function = reinterpret_cast<Function>(getDeviceProcAddr(handle, fallback));
+        }
+    };
+
+    load(vkAcquireNextImageKHR, "vkAcquireNextImageKHR");
+    load(vkQueuePresentKHR, "vkQueuePresentKHR");
+    load(vkQueueSubmit, "vkQueueSubmit");
+    load(vkWaitForFences, "vkWaitForFences");
+    load(vkWaitSemaphores, "vkWaitSemaphores", "vkWaitSemaphoresKHR");
+    load(vkGetSemaphoreCounterValue, "vkGetSemaphoreCounterValue", "vkGetSemaphoreCounterValueKHR");
+    load(vkResetCommandPool, "vkResetCommandPool");
+    load(vkBeginCommandBuffer, "vkBeginCommandBuffer");
+    load(vkEndCommandBuffer, "vkEndCommandBuffer");
+    load(vkCmdExecuteCommands, "vkCmdExecuteCommands");
+    load(vkCmdResetQueryPool, "vkCmdResetQueryPool");
+    load(vkCmdWriteTimestamp, "vkCmdWriteTimestamp");
+    load(vkCmdBeginRenderPass, "vkCmdBeginRenderPass");
+    load(vkCmdEndRenderPass, "vkCmdEndRenderPass");
+    load(vkCmdBeginRendering, "vkCmdBeginRendering", "vkCmdBeginRenderingKHR");
+    load(vkCmdEndRendering, "vkCmdEndRendering", "vkCmdEndRenderingKHR");
+    load(vkCmdPipelineBarrier, "vkCmdPipelineBarrier");
+    load(vkCmdPipelineBarrier2, "vkCmdPipelineBarrier2", "vkCmdPipelineBarrier2KHR");
+    load(vkCmdBindPipeline, "vkCmdBindPipeline");
+    load(vkCmdBindDescriptorSets, "vkCmdBindDescriptorSets");
+    load(vkCmdBindVertexBuffers, "vkCmdBindVertexBuffers");
+    load(vkCmdBindIndexBuffer, "vkCmdBindIndexBuffer");
+    load(vkCmdPushConstants, "vkCmdPushConstants");
+    load(vkCmdSetViewport, "vkCmdSetViewport");
+    load(vkCmdSetScissor, "vkCmdSetScissor");
+    load(vkCmdDraw, "vkCmdDraw");
+    load(vkCmdDrawIndexed, "vkCmdDrawIndexed");
+    load(vkCmdDrawIndexedIndirectCount, "vkCmdDrawIndexedIndirectCount", "vkCmdDrawIndexedIndirectCountKHR");
+    load(vkCmdDispatch, "vkCmdDispatch");
+    load(vkCmdFillBuffer, "vkCmdFillBuffer");
+}
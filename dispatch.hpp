@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+#ifndef ENGINE_DEVICE_DISPATCH
+#define ENGINE_DEVICE_DISPATCH 0
+#endif
+
+// Device level entry points of the per-frame path, loaded straight from
+// vkGetDeviceProcAddr in the style of volk. The whole table spans a few cache
+// lines instead of the thousands of pointers in DispatchLoaderDynamic, and it
+// can be passed to vulkan.hpp as the dispatcher for every call it covers.
+struct DeviceDispatch {
+    PFN_vkAcquireNextImageKHR               vkAcquireNextImageKHR               {};
+    PFN_vkQueuePresentKHR                   vkQueuePresentKHR                   {};
+    PFN_vkQueueSubmit                       vkQueueSubmit                       {};
+    PFN_vkWaitForFences                     vkWaitForFences                     {};
+    PFN_vkWaitSemaphores                    vkWaitSemaphores                    {};
+    PFN_vkGetSemaphoreCounterValue          vkGetSemaphoreCounterValue          {};
+    PFN_vkResetCommandPool                  vkResetCommandPool                  {};
+    PFN_vkBeginCommandBuffer                vkBeginCommandBuffer                {};
+    PFN_vkEndCommandBuffer                  vkEndCommandBuffer                  {};
+    PFN_vkCmdExecuteCommands                vkCmdExecuteCommands                {};
+    PFN_vkCmdResetQueryPool                 vkCmdResetQueryPool                 {};
+    PFN_vkCmdWriteTimestamp                 vkCmdWriteTimestamp                 {};
+    PFN_vkCmdBeginRenderPass                vkCmdBeginRenderPass                {};
+    PFN_vkCmdEndRenderPass                  vkCmdEndRenderPass                  {};
+    PFN_vkCmdBeginRendering                 vkCmdBeginRendering                 {};
+    PFN_vkCmdEndRendering                   vkCmdEndRendering                   {};
+    PFN_vkCmdPipelineBarrier                vkCmdPipelineBarrier                {};
+    PFN_vkCmdPipelineBarrier2               vkCmdPipelineBarrier2               {};
+    PFN_vkCmdBindPipeline                   vkCmdBindPipeline                   {};
+    PFN_vkCmdBindDescriptorSets             vkCmdBindDescriptorSets             {};
+    PFN_vkCmdBindVertexBuffers              vkCmdBindVertexBuffers              {};
+    PFN_vkCmdBindIndexBuffer                vkCmdBindIndexBuffer                {};
+    PFN_vkCmdPushConstants                  vkCmdPushConstants                  {};
+    PFN_vkCmdSetViewport                    vkCmdSetViewport                    {};
+    PFN_vkCmdSetScissor                     vkCmdSetScissor                     {};
+    PFN_vkCmdDraw                           vkCmdDraw                           {};
+    PFN_vkCmdDrawIndexed                    vkCmdDrawIndexed                    {};
+    PFN_vkCmdDrawIndexedIndirectCount       vkCmdDrawIndexedIndirectCount       {};
+    PFN_vkCmdDispatch                       vkCmdDispatch                       {};
+    PFN_vkCmdFillBuffer                     vkCmdFillBuffer                     {};
+
+    void init(vk::Device device, PFN_vkGetDeviceProcAddr getDeviceProcAddr);
+
+    std::size_t getVkHeaderVersion() const {
+        return VK_HEADER_VERSION;
+    }
+};
+
+// Dispatcher used by the per-frame path, chosen with ENGINE_DEVICE_DISPATCH.
+#if ENGINE_DEVICE_DISPATCH
+using FrameDispatch = DeviceDispatch;
+#else
+using FrameDispatch = vk::DispatchLoaderDynamic;
+#endif
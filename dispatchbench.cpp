@@ -0,0 +1,166 @@
+#include "window.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <string>
+
+// Compares the per-call cost of calls on the frame path through the loader
+// trampolines (a DispatchLoaderDynamic initialised from the instance only),
+// the window's DispatchLoaderDynamic and DeviceDispatch. The last two both
+// call device-level entry points, so they differ only in the table lookup.
+// A valid vkCmdDraw needs a pipeline and attachments, so command recording
+// is measured with dynamic state commands, which go through the same dispatch.
+int main(int argc, char** argv) {
+
+    uint32_t const calls = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 1000000;
+    uint32_t const submits = std::max(calls / 100, 1u);
+    uint32_t const batch = 4096;
+
+    // Layers intercept every call and would dominate what is measured here.
+    SDL_setenv_unsafe("VK_LOADER_LAYERS_DISABLE", "~all~", 1);
+
+    auto window = Window::createHeadlessWindow(64, 64);
+
+    vk::Device const device = window.getDevice();
+    vk::Queue const queue = window.getQueue();
+    vk::Semaphore const timeline = window.getGraphicsTimeline().semaphore();
+    vk::DispatchLoaderDynamic const& loader = window.getLoader();
+    DeviceDispatch const& table = window.getDeviceDispatch();
+
+    // Device functions looked up through vkGetInstanceProcAddr resolve to the
+    // loader trampolines that an application without per-device dispatch uses.
+    vk::DispatchLoaderDynamic trampolines {};
+    trampolines.init(window.getContext()->getInstance(), loader.vkGetInstanceProcAddr);
+
+    vk::CommandPoolCreateInfo const commandPoolCreateInfo
+    {
+        .sType = vk::StructureType::eCommandPoolCreateInfo,
+        .pNext = {},
+        .flags = vk::CommandPoolCreateFlagBits::eTransient,
+        .queueFamilyIndex = window.getQueueFamilyIndex()
+    };
+
+    vk::CommandPool commandPool;
+    if(device.createCommandPool(&commandPoolCreateInfo, nullptr, &commandPool, loader) != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: dispatchbench createCommandPool()");
+    }
+
+    vk::CommandBufferAllocateInfo const commandBufferAllocateInfo
+    {
+        .sType = vk::StructureType::eCommandBufferAllocateInfo,
+        .pNext = {},
+        .commandPool = commandPool,
+        .level = vk::CommandBufferLevel::ePrimary,
+        .commandBufferCount = 1
+    };
+
+    vk::CommandBuffer commandBuffer;
+    if(device.allocateCommandBuffers(&commandBufferAllocateInfo, &commandBuffer, loader) != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: dispatchbench allocateCommandBuffers()");
+    }
+
+    vk::FenceCreateInfo const fenceCreateInfo
+    {
+        .sType = vk::StructureType::eFenceCreateInfo,
+        .pNext = {},
+        .flags = vk::FenceCreateFlagBits::eSignaled
+    };
+
+    vk::Fence fence;
+    if(device.createFence(&fenceCreateInfo, nullptr, &fence, loader) != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: dispatchbench createFence()");
+    }
+
+    vk::CommandBufferBeginInfo const commandBufferBeginInfo
+    {
+        .sType = vk::StructureType::eCommandBufferBeginInfo,
+        .pNext = {},
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+        .pInheritanceInfo = {}
+    };
+
+    vk::Viewport const viewport { .x = 0.0f, .y = 0.0f, .width = 64.0f, .height = 64.0f, .minDepth = 0.0f, .maxDepth = 1.0f };
+    vk::Rect2D const scissor { .offset = {0, 0}, .extent = {64, 64} };
+
+    vk::SubmitInfo const submitInfo
+    {
+        .sType = vk::StructureType::eSubmitInfo,
+        .pNext = {},
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = {},
+        .pWaitDstStageMask = {},
+        .commandBufferCount = 0,
+        .pCommandBuffers = {},
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = {}
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // Recording is split into batches so the command buffer stays small;
+    // only the calls themselves are timed.
+    auto const record = [&](auto const& dispatch) {
+        Clock::duration elapsed {};
+        for(uint32_t done = 0; done < calls; done += batch) {
+            uint32_t const count = std::min(batch, calls - done);
+            static_cast<void>(commandBuffer.begin(&commandBufferBeginInfo, dispatch));
+
+            auto const start = Clock::now();
+            for(uint32_t x=0; x<count; x++) {
+                commandBuffer.setViewport(0, 1, &viewport, dispatch);
+                commandBuffer.setScissor(0, 1, &scissor, dispatch);
+            }
+            elapsed += Clock::now() - start;
+
+            static_cast<void>(commandBuffer.end(dispatch));
+            static_cast<void>(device.resetCommandPool(commandPool, {}, dispatch));
+        }
+        return std::chrono::duration<double, std::nano>(elapsed).count() / (2.0 * calls);
+    };
+
+    auto const submit = [&](auto const& dispatch) {
+        auto const start = Clock::now();
+        for(uint32_t x=0; x<submits; x++) {
+            static_cast<void>(queue.submit(1, &submitInfo, {}, dispatch));
+        }
+        auto const elapsed = Clock::now() - start;
+        static_cast<void>(queue.waitIdle(loader));
+        return std::chrono::duration<double, std::nano>(elapsed).count() / submits;
+    };
+
+    auto const waitForFences = [&](auto const& dispatch) {
+        auto const start = Clock::now();
+        for(uint32_t x=0; x<calls; x++) {
+            static_cast<void>(device.waitForFences(1, &fence, vk::True, 0, dispatch));
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls;
+    };
+
+    auto const counterValue = [&](auto const& dispatch) {
+        uint64_t value {};
+        auto const start = Clock::now();
+        for(uint32_t x=0; x<calls; x++) {
+            static_cast<void>(device.getSemaphoreCounterValue(timeline, &value, dispatch));
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls;
+    };
+
+    auto const report = [&trampolines, &loader, &table](char const* name, auto const& benchmark) {
+        double const instance = benchmark(trampolines);
+        double const dynamic = benchmark(loader);
+        double const compact = benchmark(table);
+        std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << instance << std::setw(12) << dynamic << std::setw(12) << compact
+                  << std::setw(10) << instance / compact << "x" << std::endl;
+    };
+
+    std::cout << std::left << std::setw(28) << "ns/call" << std::right << std::setw(12) << "instance" << std::setw(12) << "dynamic" << std::setw(12) << "device" << std::setw(11) << "speedup" << std::endl;
+
+    report("cmdSetViewport/Scissor", record);
+    report("queueSubmit", submit);
+    report("waitForFences", waitForFences);
+    report("getSemaphoreCounterValue", counterValue);
+
+    device.destroyFence(fence, nullptr, loader);
+    device.destroyCommandPool(commandPool, nullptr, loader);
+}
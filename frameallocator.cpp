@@ -0,0 +1,88 @@
+#include "frameallocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+void FrameAllocator::create(vk::Device device, vk::PhysicalDevice physicalDevice, Allocator& allocator, vk::DeviceSize capacity, vk::DispatchLoaderDynamic const& loader) {
+
+    m_device = device;
+
+    vk::PhysicalDeviceLimits const limits = physicalDevice.getProperties(loader).limits;
+    m_alignment = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+
+    vk::BufferCreateInfo const bufferCreateInfo
+    {
+        .sType = vk::StructureType::eBufferCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .size = capacity,
+        .usage = vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer,
+        .sharingMode = vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = {},
+        .pQueueFamilyIndices = {}
+    };
+
+    if(m_device.createBuffer(&bufferCreateInfo, nullptr, &m_buffer, loader) != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: FrameAllocator::create()");
+    }
+
+    m_pool.create(allocator, m_device.getBufferMemoryRequirements(m_buffer, loader), vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, ResourceKind::eLinear, loader);
+
+    Allocation const& allocation = m_pool.allocation();
+    if(!allocation.mapped) {
+        throw std::runtime_error("Error: FrameAllocator::create() memory is not mapped");
+    }
+
+    m_device.bindBufferMemory(m_buffer, allocation.memory, allocation.offset, loader);
+}
+
+void FrameAllocator::destroy(Allocator& allocator, vk::DispatchLoaderDynamic const& loader) {
+
+    if(!m_buffer) {
+        return;
+    }
+
+    m_device.destroyBuffer(m_buffer, nullptr, loader);
+    m_pool.destroy(allocator, loader);
+    m_buffer = nullptr;
+}
+
+std::optional<FrameAllocation> FrameAllocator::allocate(vk::DeviceSize size) {
+
+    auto const allocation = m_pool.allocate(size, m_alignment);
+    if(!allocation) {
+        return std::nullopt;
+    }
+
+    return FrameAllocation
+    {
+        .buffer = m_buffer,
+        .offset = static_cast<uint32_t>(allocation->offset - m_pool.allocation().offset),
+        .size = size,
+        .mapped = allocation->mapped
+    };
+}
+
+void FrameAllocator::reset() {
+    m_pool.reset();
+}
+
+vk::Buffer FrameAllocator::buffer() const {
+    return m_buffer;
+}
+
+vk::DescriptorBufferInfo FrameAllocator::descriptorInfo(vk::DeviceSize range) const {
+    return vk::DescriptorBufferInfo { .buffer = m_buffer, .offset = 0, .range = range };
+}
+
+vk::DeviceSize FrameAllocator::alignment() const {
+    return m_alignment;
+}
+
+vk::DeviceSize FrameAllocator::used() const {
+    return m_pool.used();
+}
+
+vk::DeviceSize FrameAllocator::capacity() const {
+    return m_pool.capacity();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#include "allocator.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+// A slice of a frame buffer. offset is relative to the buffer and can be
+// passed directly as a dynamic offset or a vertex/index buffer offset.
+struct FrameAllocation {
+    vk::Buffer                          buffer          {};
+    uint32_t                            offset          {};
+    vk::DeviceSize                      size            {};
+    void*                               mapped          {};
+};
+
+// Per-frame scratch memory for uniforms, transient vertices and indices. A
+// LinearPool of host-visible, coherent memory backs one persistently mapped
+// buffer; allocations are aligned for dynamic uniform and storage offsets.
+// The owner resets it once the frame that used it has completed. Not thread
+// safe: only the thread recording the frame allocates from it, parallel
+// recording slices do not.
+class FrameAllocator final {
+
+    private:
+        vk::Device                          m_device                    {};
+        vk::Buffer                          m_buffer                    {};
+        LinearPool                          m_pool                      {};
+        vk::DeviceSize                      m_alignment                 {};
+
+    public:
+        void create(vk::Device device, vk::PhysicalDevice physicalDevice, Allocator& allocator, vk::DeviceSize capacity, vk::DispatchLoaderDynamic const& loader);
+        void destroy(Allocator& allocator, vk::DispatchLoaderDynamic const& loader);
+
+        std::optional<FrameAllocation> allocate(vk::DeviceSize size);
+
+        template<typename T>
+        std::optional<FrameAllocation> push(T const& value) {
+            auto allocation = allocate(sizeof(T));
+            if(allocation) std::memcpy(allocation->mapped, &value, sizeof(T));
+            return allocation;
+        }
+
+        void reset();
+
+        vk::Buffer buffer() const;
+        vk::DescriptorBufferInfo descriptorInfo(vk::DeviceSize range) const;
+        vk::DeviceSize alignment() const;
+        vk::DeviceSize used() const;
+        vk::DeviceSize capacity() const;
+};
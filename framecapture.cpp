@@ -0,0 +1,337 @@
+#include "framecapture.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    bool blueFirst(vk::Format format) {
+        return format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb;
+    }
+}
+
+bool FrameCapture::supported(vk::Format format) {
+    switch(format) {
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Srgb:
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+            return true;
+        default:
+            return false;
+    }
+}
+
+FrameCapture::Encoder FrameCapture::imageSequence(std::filesystem::path directory) {
+
+    std::filesystem::create_directories(directory);
+
+    return [directory = std::move(directory)](CapturedFrame const& frame) {
+
+        std::string number = std::to_string(frame.frame);
+        number.insert(0, number.size() < 6 ? 6 - number.size() : 0, '0');
+
+        std::ofstream stream(directory / ("frame_" + number + ".ppm"), std::ios::binary);
+        stream << "P6\n" << frame.extent.width << " " << frame.extent.height << "\n255\n";
+
+        bool const swap = blueFirst(frame.format);
+        std::vector<char> row(std::size_t{frame.extent.width} * 3);
+        for(uint32_t y=0; y<frame.extent.height; y++) {
+            std::byte const* pixel = frame.pixels.data() + std::size_t{y} * frame.extent.width * 4;
+            for(uint32_t x=0; x<frame.extent.width; x++, pixel += 4) {
+                row[x * 3 + 0] = static_cast<char>(pixel[swap ? 2 : 0]);
+                row[x * 3 + 1] = static_cast<char>(pixel[1]);
+                row[x * 3 + 2] = static_cast<char>(pixel[swap ? 0 : 2]);
+            }
+            stream.write(row.data(), static_cast<std::streamsize>(row.size()));
+        }
+    };
+}
+
+FrameCapture::Encoder FrameCapture::rawStream(std::filesystem::path path) {
+
+    auto stream = std::make_shared<std::ofstream>(path, std::ios::binary);
+    if(!*stream) {
+        throw std::runtime_error("Error: FrameCapture::rawStream()");
+    }
+
+    return [stream](CapturedFrame const& frame) {
+        stream->write(reinterpret_cast<char const*>(frame.pixels.data()), static_cast<std::streamsize>(frame.pixels.size()));
+        stream->flush();
+    };
+}
+
+void FrameCapture::create(vk::Device device, Allocator& allocator, Encoder encoder, uint32_t slotCount) {
+
+    m_device = device;
+    m_allocator = &allocator;
+    m_encoder = std::move(encoder);
+    m_slotCount = std::clamp(slotCount, 1u, MaxSlots);
+    m_next = 0;
+    m_captured = 0;
+    m_dropped = 0;
+    m_stop.store(false, std::memory_order_relaxed);
+
+    m_worker = std::thread([this] { encodeLoop(); });
+}
+
+void FrameCapture::destroy(vk::DispatchLoaderDynamic const& loader) {
+
+    if(!m_device) {
+        return;
+    }
+
+    // The caller has waited for the device, so every submitted slot is done.
+    collect(UINT64_MAX);
+
+    m_stop.store(true, std::memory_order_release);
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
+    m_worker.join();
+
+    for(auto& slot : m_slots) {
+        if(slot.buffer) m_device.destroyBuffer(slot.buffer, nullptr, loader);
+        if(slot.allocation.memory) m_allocator->free(slot.allocation, loader);
+        slot.buffer = vk::Buffer {};
+        slot.allocation = Allocation {};
+        slot.capacity = 0;
+        slot.state.store(SlotState::eFree, std::memory_order_relaxed);
+    }
+
+    m_device = vk::Device {};
+}
+
+void FrameCapture::reserve(Slot& slot, vk::DeviceSize size, vk::DispatchLoaderDynamic const& loader) {
+
+    if(slot.capacity >= size) {
+        return;
+    }
+
+    // Only free slots are resized, so the old buffer is neither read by the
+    // GPU nor by the encoder.
+    if(slot.buffer) m_device.destroyBuffer(slot.buffer, nullptr, loader);
+    if(slot.allocation.memory) m_allocator->free(slot.allocation, loader);
+
+    vk::BufferCreateInfo const bufferCreateInfo
+    {
+        .sType = vk::StructureType::eBufferCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .size = size,
+        .usage = vk::BufferUsageFlagBits::eTransferDst,
+        .sharingMode = vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = {},
+        .pQueueFamilyIndices = {}
+    };
+
+    vk::Result result = m_device.createBuffer(&bufferCreateInfo, nullptr, &slot.buffer, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: FrameCapture::reserve()");
+    }
+
+    // Reading back from uncached memory is several times slower on the CPU,
+    // so cached memory is preferred wherever the device has it.
+    auto const requirements = m_device.getBufferMemoryRequirements(slot.buffer, loader);
+    auto const& memoryProperties = m_allocator->memoryProperties();
+
+    vk::MemoryPropertyFlags properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent | vk::MemoryPropertyFlagBits::eHostCached;
+    bool cached = false;
+    for(uint32_t x=0; x<memoryProperties.memoryTypeCount; x++) {
+        cached = cached || ((requirements.memoryTypeBits & (1u << x)) && (memoryProperties.memoryTypes[x].propertyFlags & properties) == properties);
+    }
+    if(!cached) {
+        properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    }
+
+    slot.allocation = m_allocator->allocate(requirements, properties, ResourceKind::eLinear, loader);
+    m_device.bindBufferMemory(slot.buffer, slot.allocation.memory, slot.allocation.offset, loader);
+    slot.capacity = size;
+}
+
+uint32_t FrameCapture::record(vk::CommandBuffer commandBuffer, vk::Image image, vk::Extent2D extent, vk::Format format, vk::ImageLayout layout, uint64_t frame, vk::DispatchLoaderDynamic const& loader) {
+
+    uint32_t const index = m_next;
+    Slot& slot = m_slots[index];
+
+    if(!supported(format) || slot.state.load(std::memory_order_acquire) != SlotState::eFree) {
+        m_dropped++;
+        return InvalidSlot;
+    }
+
+    reserve(slot, vk::DeviceSize{extent.width} * extent.height * 4, loader);
+    slot.extent = extent;
+    slot.format = format;
+    slot.frame = frame;
+    slot.value = 0;
+    slot.state.store(SlotState::eRecorded, std::memory_order_relaxed);
+    m_next = (m_next + 1) % m_slotCount;
+
+    vk::ImageSubresourceRange const subresourceRange
+    {
+        .aspectMask = vk::ImageAspectFlagBits::eColor,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1
+    };
+
+    // Offscreen images already end the frame in TRANSFER_SRC_OPTIMAL.
+    bool const transition = layout != vk::ImageLayout::eTransferSrcOptimal;
+
+    if(transition) {
+        vk::ImageMemoryBarrier const imageMemoryBarrier
+        {
+            .sType = vk::StructureType::eImageMemoryBarrier,
+            .pNext = {},
+            .srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+            .dstAccessMask = vk::AccessFlagBits::eTransferRead,
+            .oldLayout = layout,
+            .newLayout = vk::ImageLayout::eTransferSrcOptimal,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image,
+            .subresourceRange = subresourceRange
+        };
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, imageMemoryBarrier, loader);
+    }
+
+    vk::BufferImageCopy const region
+    {
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource =
+        {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        },
+        .imageOffset = { 0, 0, 0 },
+        .imageExtent = { extent.width, extent.height, 1 }
+    };
+
+    commandBuffer.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, slot.buffer, region, loader);
+
+    if(transition) {
+        vk::ImageMemoryBarrier const imageMemoryBarrier
+        {
+            .sType = vk::StructureType::eImageMemoryBarrier,
+            .pNext = {},
+            .srcAccessMask = vk::AccessFlagBits::eTransferRead,
+            .dstAccessMask = {},
+            .oldLayout = vk::ImageLayout::eTransferSrcOptimal,
+            .newLayout = layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image,
+            .subresourceRange = subresourceRange
+        };
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, nullptr, imageMemoryBarrier, loader);
+    }
+
+    vk::BufferMemoryBarrier const bufferMemoryBarrier
+    {
+        .sType = vk::StructureType::eBufferMemoryBarrier,
+        .pNext = {},
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = vk::AccessFlagBits::eHostRead,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = slot.buffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE
+    };
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, nullptr, bufferMemoryBarrier, nullptr, loader);
+
+    return index;
+}
+
+void FrameCapture::submit(uint32_t slot, uint64_t value) {
+
+    if(slot == InvalidSlot) {
+        return;
+    }
+
+    m_slots[slot].value = value;
+    m_slots[slot].state.store(SlotState::eSubmitted, std::memory_order_release);
+}
+
+void FrameCapture::collect(uint64_t completedValue) {
+
+    uint32_t count = 0;
+    std::array<uint32_t, MaxSlots> finished {};
+
+    for(uint32_t x=0; x<m_slotCount; x++) {
+        Slot const& slot = m_slots[x];
+        if(slot.state.load(std::memory_order_relaxed) == SlotState::eSubmitted && slot.value <= completedValue) {
+            finished[count++] = x;
+        }
+    }
+
+    if(count == 0) {
+        return;
+    }
+
+    // Encoders that write a stream rely on frames arriving in order.
+    std::sort(finished.begin(), finished.begin() + count, [this](uint32_t a, uint32_t b) {
+        return m_slots[a].frame < m_slots[b].frame;
+    });
+
+    for(uint32_t x=0; x<count; x++) {
+        m_slots[finished[x]].state.store(SlotState::eEncoding, std::memory_order_relaxed);
+        m_ready.tryPush(finished[x]);
+    }
+
+    m_captured += count;
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
+}
+
+void FrameCapture::encodeLoop() {
+
+    PROFILE_THREAD("capture");
+
+    while(true) {
+
+        uint32_t const wake = m_wake.load(std::memory_order_acquire);
+        bool const stop = m_stop.load(std::memory_order_acquire);
+
+        uint32_t index;
+        while(m_ready.tryPop(index)) {
+            PROFILE_ZONE("encodeFrame");
+
+            Slot& slot = m_slots[index];
+            CapturedFrame const frame
+            {
+                .frame = slot.frame,
+                .extent = slot.extent,
+                .format = slot.format,
+                .pixels = std::span(static_cast<std::byte const*>(slot.allocation.mapped), vk::DeviceSize{slot.extent.width} * slot.extent.height * 4)
+            };
+
+            if(m_encoder) m_encoder(frame);
+            slot.state.store(SlotState::eFree, std::memory_order_release);
+        }
+
+        if(stop) {
+            return;
+        }
+
+        m_wake.wait(wake, std::memory_order_acquire);
+    }
+}
+
+uint64_t FrameCapture::captured() const {
+    return m_captured;
+}
+
+uint64_t FrameCapture::dropped() const {
+    return m_dropped;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <thread>
+
+#include "allocator.hpp"
+#include "spscqueue.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+// Tightly packed 8-bit RGBA or BGRA pixels of one finished frame. Only valid
+// for the duration of the encoder call.
+struct CapturedFrame {
+    uint64_t                            frame           {};
+    vk::Extent2D                        extent          {};
+    vk::Format                          format          {};
+    std::span<std::byte const>          pixels          {};
+};
+
+// Copies rendered images into a ring of persistently mapped readback buffers
+// from the frame command buffer. collect() hands slots whose timeline value
+// has been reached to a worker thread that runs the encoder. Nothing here
+// waits on the GPU: when every slot is still in flight or being encoded the
+// frame is dropped instead.
+class FrameCapture final {
+
+    public:
+        using Encoder = std::function<void(CapturedFrame const& frame)>;
+
+        static constexpr uint32_t MaxSlots = 8;
+        static constexpr uint32_t InvalidSlot = UINT32_MAX;
+
+    private:
+        enum class SlotState : uint32_t {
+            eFree,
+            eRecorded,
+            eSubmitted,
+            eEncoding
+        };
+
+        struct Slot {
+            vk::Buffer                  buffer          {};
+            Allocation                  allocation      {};
+            vk::DeviceSize              capacity        {};
+            vk::Extent2D                extent          {};
+            vk::Format                  format          {};
+            uint64_t                    frame           {};
+            uint64_t                    value           {};
+            std::atomic<SlotState>      state           {};
+        };
+
+    private:
+        vk::Device                          m_device                    {};
+        Allocator*                          m_allocator                 {};
+        Encoder                             m_encoder                   {};
+        std::array<Slot, MaxSlots>          m_slots                     {};
+        uint32_t                            m_slotCount                 {};
+        uint32_t                            m_next                      {};
+        uint64_t                            m_captured                  {};
+        uint64_t                            m_dropped                   {};
+        std::thread                         m_worker                    {};
+        std::atomic<bool>                   m_stop                      {};
+        std::atomic<uint32_t>               m_wake                      {};
+        SpscQueue<uint32_t, MaxSlots>       m_ready                     {};
+
+    private:
+        void reserve(Slot& slot, vk::DeviceSize size, vk::DispatchLoaderDynamic const& loader);
+        void encodeLoop();
+
+    public:
+        static bool supported(vk::Format format);
+        static Encoder imageSequence(std::filesystem::path directory);
+        static Encoder rawStream(std::filesystem::path path);
+
+    public:
+        void create(vk::Device device, Allocator& allocator, Encoder encoder, uint32_t slotCount = 3);
+        void destroy(vk::DispatchLoaderDynamic const& loader);
+
+        uint32_t record(vk::CommandBuffer commandBuffer, vk::Image image, vk::Extent2D extent, vk::Format format, vk::ImageLayout layout, uint64_t frame, vk::DispatchLoaderDynamic const& loader);
+        void submit(uint32_t slot, uint64_t value);
+        void collect(uint64_t completedValue);
+
+        uint64_t captured() const;
+        uint64_t dropped() const;
+};
@@ -0,0 +1,144 @@
+#include "frametimer.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+void FrameTiming::beginPhase(FramePhase phase) {
+    begin[static_cast<std::size_t>(phase)] = FrameTimer::now();
+}
+
+void FrameTiming::endPhase(FramePhase phase) {
+    end[static_cast<std::size_t>(phase)] = FrameTimer::now();
+}
+
+double FrameTiming::cpuTime(FramePhase phase) const {
+    auto const x = static_cast<std::size_t>(phase);
+    return end[x] > begin[x] ? static_cast<double>(end[x] - begin[x]) / 1e6 : 0.0;
+}
+
+uint64_t FrameTimer::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+char const* FrameTimer::phaseName(FramePhase phase) {
+    switch(phase) {
+        case FramePhase::eWaitFrame:            return "waitFrame";
+        case FramePhase::eAcquire:              return "acquire";
+        case FramePhase::eResetCommandPool:     return "resetCommandPool";
+        case FramePhase::eRecord:               return "record";
+        case FramePhase::eSubmit:               return "submit";
+        case FramePhase::ePresent:              return "present";
+        default:                                return "unknown";
+    }
+}
+
+void FrameTimer::setTimestampPeriod(double timestampPeriod) {
+    m_timestampPeriod = timestampPeriod;
+}
+
+double FrameTimer::timestampPeriod() const {
+    return m_timestampPeriod;
+}
+
+void FrameTimer::push(FrameTiming const& timing) {
+
+    uint64_t const index = m_written.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[index % Capacity];
+
+    uint64_t const sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.index.store(index, std::memory_order_relaxed);
+    slot.frame.store(timing.frame, std::memory_order_relaxed);
+    for(std::size_t x=0; x<FramePhaseCount; x++) {
+        slot.begin[x].store(timing.begin[x], std::memory_order_relaxed);
+        slot.end[x].store(timing.end[x], std::memory_order_relaxed);
+    }
+    slot.gpuTime.store(timing.gpuTime, std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    m_written.store(index + 1, std::memory_order_release);
+}
+
+bool FrameTimer::read(uint64_t index, FrameTiming& timing) const {
+
+    Slot const& slot = m_slots[index % Capacity];
+
+    for(;;) {
+        uint64_t const sequence = slot.sequence.load(std::memory_order_acquire);
+        if(sequence & 1) {
+            continue;
+        }
+
+        uint64_t const slotIndex = slot.index.load(std::memory_order_relaxed);
+        timing.frame = slot.frame.load(std::memory_order_relaxed);
+        for(std::size_t x=0; x<FramePhaseCount; x++) {
+            timing.begin[x] = slot.begin[x].load(std::memory_order_relaxed);
+            timing.end[x] = slot.end[x].load(std::memory_order_relaxed);
+        }
+        timing.gpuTime = slot.gpuTime.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.sequence.load(std::memory_order_relaxed) == sequence) {
+            return slotIndex == index;
+        }
+    }
+}
+
+bool FrameTimer::latest(FrameTiming& timing) const {
+
+    uint64_t const written = m_written.load(std::memory_order_acquire);
+    return written != 0 && read(written - 1, timing);
+}
+
+std::vector<FrameTiming> FrameTimer::snapshot(std::size_t count) const {
+
+    uint64_t const written = m_written.load(std::memory_order_acquire);
+    uint64_t const available = std::min<uint64_t>({ written, count, Capacity - 1 });
+
+    std::vector<FrameTiming> timings;
+    timings.reserve(available);
+
+    for(uint64_t index = written - available; index < written; index++) {
+        FrameTiming timing;
+        if(read(index, timing)) {
+            timings.push_back(timing);
+        }
+    }
+
+    return timings;
+}
+
+void FrameTimer::writeChromeTrace(std::ostream& stream) const {
+
+    auto const timings = snapshot();
+
+    auto const event = [&stream](char const* name, uint32_t tid, uint64_t frame, uint64_t begin, uint64_t duration, bool first) {
+        stream << (first ? "" : ",\n")
+               << "{\"name\":\"" << name << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+               << ",\"ts\":" << begin / 1000.0 << ",\"dur\":" << duration / 1000.0
+               << ",\"args\":{\"frame\":" << frame << "}}";
+    };
+
+    stream << "{\"traceEvents\":[\n";
+
+    bool first = true;
+    for(auto const& timing : timings) {
+        for(std::size_t x=0; x<FramePhaseCount; x++) {
+            if(timing.end[x] <= timing.begin[x]) {
+                continue;
+            }
+            event(phaseName(static_cast<FramePhase>(x)), 0, timing.frame, timing.begin[x], timing.end[x] - timing.begin[x], first);
+            first = false;
+        }
+
+        // GPU and CPU clocks are not calibrated, the GPU span is anchored at the end of the submit.
+        if(timing.gpuTime != 0) {
+            event("gpu", 1, timing.frame, timing.end[static_cast<std::size_t>(FramePhase::eSubmit)], timing.gpuTime, first);
+            first = false;
+        }
+    }
+
+    stream << "\n]}\n";
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+enum class FramePhase : uint32_t {
+    eWaitFrame,
+    eAcquire,
+    eResetCommandPool,
+    eRecord,
+    eSubmit,
+    ePresent,
+    eCount
+};
+
+constexpr std::size_t FramePhaseCount = static_cast<std::size_t>(FramePhase::eCount);
+
+struct FrameTiming {
+    uint64_t                                    frame       {};
+    std::array<uint64_t, FramePhaseCount>       begin       {};
+    std::array<uint64_t, FramePhaseCount>       end         {};
+    uint64_t                                    gpuTime     {};
+
+    void beginPhase(FramePhase phase);
+    void endPhase(FramePhase phase);
+    double cpuTime(FramePhase phase) const;
+};
+
+// Single producer (the render loop), any number of readers. Every slot is
+// guarded by a sequence counter so readers never block the producer.
+class FrameTimer final {
+
+    public:
+        static constexpr std::size_t Capacity = 512;
+
+    private:
+        struct Slot {
+            std::atomic<uint64_t>                                   sequence    {};
+            std::atomic<uint64_t>                                   index       {};
+            std::atomic<uint64_t>                                   frame       {};
+            std::array<std::atomic<uint64_t>, FramePhaseCount>      begin       {};
+            std::array<std::atomic<uint64_t>, FramePhaseCount>      end         {};
+            std::atomic<uint64_t>                                   gpuTime     {};
+        };
+
+    private:
+        std::array<Slot, Capacity>      m_slots                     {};
+        std::atomic<uint64_t>           m_written                   {};
+        double                          m_timestampPeriod           {};
+
+    private:
+        bool read(uint64_t index, FrameTiming& timing) const;
+
+    public:
+        static uint64_t now();
+        static char const* phaseName(FramePhase phase);
+
+    public:
+        void setTimestampPeriod(double timestampPeriod);
+        double timestampPeriod() const;
+
+        void push(FrameTiming const& timing);
+        bool latest(FrameTiming& timing) const;
+        std::vector<FrameTiming> snapshot(std::size_t count = Capacity) const;
+        void writeChromeTrace(std::ostream& stream) const;
+};
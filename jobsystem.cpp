@@ -0,0 +1,120 @@
+#include "jobsystem.hpp"
+
+#include <string>
+
+#include "profiler.hpp"
+
+JobSystem::JobSystem(uint32_t threadCount) {
+
+    for(uint32_t x=0; x<threadCount; x++) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+
+    for(uint32_t x=0; x<threadCount; x++) {
+        m_threads.emplace_back(&JobSystem::run, this, x);
+    }
+}
+
+JobSystem::~JobSystem() {
+
+    {
+        std::scoped_lock lock(m_sleepMutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+
+    for(auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+uint32_t JobSystem::threadCount() const {
+    return static_cast<uint32_t>(m_workers.size());
+}
+
+bool JobSystem::pop(uint32_t workerIndex, Task& task) {
+
+    Worker& worker = *m_workers[workerIndex];
+    std::scoped_lock lock(worker.mutex);
+
+    if(worker.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(uint32_t workerIndex, Task& task, JobCounter const* counter) {
+
+    for(uint32_t x=1; x<=m_workers.size(); x++) {
+        Worker& victim = *m_workers[(workerIndex + x) % m_workers.size()];
+        std::scoped_lock lock(victim.mutex);
+
+        if(!victim.tasks.empty() && (!counter || victim.tasks.front().counter == counter)) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::execute(Task& task, uint32_t threadIndex) {
+
+    m_queued--;
+    task.job(threadIndex);
+    if(task.counter) {
+        task.counter->pending--;
+    }
+}
+
+void JobSystem::run(uint32_t workerIndex) {
+
+    PROFILE_THREAD("worker " + std::to_string(workerIndex));
+
+    while(m_running) {
+
+        Task task;
+        if(pop(workerIndex, task) || steal(workerIndex, task)) {
+            execute(task, workerIndex);
+            continue;
+        }
+
+        std::unique_lock lock(m_sleepMutex);
+        m_wake.wait(lock, [this]() { return m_queued > 0 || !m_running; });
+    }
+}
+
+void JobSystem::submit(Job job, JobCounter* counter) {
+
+    if(counter) {
+        counter->pending++;
+    }
+
+    Worker& worker = *m_workers[m_next++ % m_workers.size()];
+    {
+        std::scoped_lock lock(worker.mutex);
+        worker.tasks.push_back(Task { .job = std::move(job), .counter = counter });
+    }
+
+    {
+        std::scoped_lock lock(m_sleepMutex);
+        m_queued++;
+    }
+    m_wake.notify_one();
+}
+
+void JobSystem::wait(JobCounter& counter) {
+
+    while(counter.pending > 0) {
+        Task task;
+        if(steal(0, task, &counter)) {
+            execute(task, threadCount());
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of workers with one job deque each. A worker pops from the back
+// of its own deque and steals from the front of the others when it runs dry.
+// Jobs receive the index of the thread running them: workers use
+// [0, threadCount()), the thread blocked in wait() helps out with jobs of the
+// counter it waits for as threadCount().
+struct JobCounter {
+    std::atomic<uint32_t>               pending         {};
+};
+
+class JobSystem final {
+
+    public:
+        using Job = std::function<void(uint32_t threadIndex)>;
+
+    private:
+        struct Task {
+            Job                         job             {};
+            JobCounter*                 counter         {};
+        };
+
+        struct Worker {
+            std::deque<Task>            tasks           {};
+            std::mutex                  mutex           {};
+        };
+
+    private:
+        std::vector<std::unique_ptr<Worker>>    m_workers       {};
+        std::vector<std::thread>                m_threads       {};
+        std::atomic<bool>                       m_running       {true};
+        std::atomic<int32_t>                    m_queued        {};
+        std::atomic<uint32_t>                   m_next          {};
+        std::mutex                              m_sleepMutex    {};
+        std::condition_variable                 m_wake          {};
+
+    private:
+        bool pop(uint32_t workerIndex, Task& task);
+        bool steal(uint32_t workerIndex, Task& task, JobCounter const* counter = nullptr);
+        void run(uint32_t workerIndex);
+        void execute(Task& task, uint32_t threadIndex);
+
+    public:
+        explicit JobSystem(uint32_t threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1);
+        JobSystem(JobSystem const&) = delete;
+        JobSystem& operator = (JobSystem const&) = delete;
+        ~JobSystem();
+
+    public:
+        uint32_t threadCount() const;
+        void submit(Job job, JobCounter* counter = nullptr);
+        void wait(JobCounter& counter);
+};
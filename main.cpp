@@ -1,3 +1,4 @@
+#include "embeddedshaders.hpp"
 #include "window.hpp"
 
 int main() {
@@ -5,8 +6,18 @@ int main() {
     auto window = Window::createDefaultWindow();
 
     window.setClearColor(1, 0, 0);
+    window.setRenderOnDemand(true);
+
+    if(window.supportsIndirectDrawing()) {
+        window.createBatchRenderer({
+            .cull = shaders::cullComp,
+            .vertex = shaders::instancedVert,
+            .fragment = shaders::instancedFrag
+        });
+    }
 
     window.show();
+    window.startRenderThread();
 
     while(!window.shouldShutdown()) {
         window.pollEvent();
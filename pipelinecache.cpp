@@ -0,0 +1,188 @@
+#include "pipelinecache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+bool PipelineHandle::ready() const {
+    return m_state && m_state->ready.load(std::memory_order_acquire);
+}
+
+vk::Pipeline PipelineHandle::get() const {
+    return ready() ? m_state->pipeline : vk::Pipeline {};
+}
+
+vk::Pipeline PipelineHandle::getOr(vk::Pipeline placeholder) const {
+    vk::Pipeline const pipeline = get();
+    return pipeline ? pipeline : placeholder;
+}
+
+void PipelineCache::create(vk::PhysicalDevice physicalDevice, vk::Device device, JobSystem& jobSystem, std::filesystem::path const& directory, vk::DispatchLoaderDynamic const& loader) {
+
+    m_device = device;
+    m_jobSystem = &jobSystem;
+
+    auto const properties = physicalDevice.getProperties(loader);
+    m_vendorID = properties.vendorID;
+    m_deviceID = properties.deviceID;
+    std::memcpy(m_uuid.data(), properties.pipelineCacheUUID.data(), m_uuid.size());
+
+    std::ostringstream name;
+    name << "pipelines_" << std::hex << std::setfill('0') << std::setw(8) << m_vendorID << "_" << std::setw(8) << m_deviceID << "_";
+    for(uint8_t byte : m_uuid) {
+        name << std::setw(2) << static_cast<uint32_t>(byte);
+    }
+    name << ".bin";
+    m_path = directory / name.str();
+
+    std::vector<uint8_t> data = load();
+    if(!validate(data)) {
+        data.clear();
+    }
+
+    vk::PipelineCacheCreateInfo const pipelineCacheCreateInfo
+    {
+        .sType = vk::StructureType::ePipelineCacheCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .initialDataSize = data.size(),
+        .pInitialData = data.data()
+    };
+
+    vk::Result result = m_device.createPipelineCache(&pipelineCacheCreateInfo, nullptr, &m_cache, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: PipelineCache::create()");
+    }
+}
+
+std::vector<uint8_t> PipelineCache::load() const {
+
+    std::ifstream file(m_path, std::ios::binary | std::ios::ate);
+    if(!file) {
+        return {};
+    }
+
+    std::vector<uint8_t> data(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    return file ? data : std::vector<uint8_t> {};
+}
+
+bool PipelineCache::validate(std::vector<uint8_t> const& data) const {
+
+    VkPipelineCacheHeaderVersionOne header {};
+    if(data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header)
+        && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+        && header.vendorID == m_vendorID
+        && header.deviceID == m_deviceID
+        && std::memcmp(header.pipelineCacheUUID, m_uuid.data(), m_uuid.size()) == 0;
+}
+
+void PipelineCache::save(vk::DispatchLoaderDynamic const& loader) {
+
+    if(!m_cache) {
+        return;
+    }
+
+    auto const data = m_device.getPipelineCacheData(m_cache, loader);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_path.parent_path(), error);
+
+    auto temporary = m_path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if(!file) {
+            return;
+        }
+    }
+
+    std::filesystem::rename(temporary, m_path, error);
+}
+
+void PipelineCache::destroy(vk::DispatchLoaderDynamic const& loader) {
+
+    if(!m_cache) {
+        return;
+    }
+
+    wait();
+    save(loader);
+
+    for(auto& state : m_pipelines) {
+        if(state->pipeline) m_device.destroyPipeline(state->pipeline, nullptr, loader);
+    }
+    m_pipelines.clear();
+
+    m_device.destroyPipelineCache(m_cache, nullptr, loader);
+    m_cache = vk::PipelineCache {};
+}
+
+vk::PipelineCache PipelineCache::cache() const {
+    return m_cache;
+}
+
+PipelineHandle PipelineCache::compile(Builder builder) {
+
+    PipelineHandle handle;
+    handle.m_state = std::make_shared<PipelineHandle::State>();
+
+    {
+        std::scoped_lock lock(m_mutex);
+        m_pipelines.push_back(handle.m_state);
+    }
+
+    m_jobSystem->submit([this, state = handle.m_state, builder = std::move(builder)](uint32_t) {
+        state->pipeline = builder(m_device, m_cache);
+        state->ready.store(true, std::memory_order_release);
+    }, &m_counter);
+
+    return handle;
+}
+
+PipelineHandle PipelineCache::compileCompute(vk::ShaderModule shaderModule, vk::PipelineLayout layout, vk::DispatchLoaderDynamic const& loader) {
+
+    return compile([shaderModule, layout, &loader](vk::Device device, vk::PipelineCache cache) {
+
+        vk::ComputePipelineCreateInfo const computePipelineCreateInfo
+        {
+            .sType = vk::StructureType::eComputePipelineCreateInfo,
+            .pNext = {},
+            .flags = {},
+            .stage = vk::PipelineShaderStageCreateInfo
+            {
+                .sType = vk::StructureType::ePipelineShaderStageCreateInfo,
+                .pNext = {},
+                .flags = {},
+                .stage = vk::ShaderStageFlagBits::eCompute,
+                .module = shaderModule,
+                .pName = "main",
+                .pSpecializationInfo = {}
+            },
+            .layout = layout,
+            .basePipelineHandle = {},
+            .basePipelineIndex = -1
+        };
+
+        vk::Pipeline pipeline;
+        vk::Result result = device.createComputePipelines(cache, 1, &computePipelineCreateInfo, nullptr, &pipeline, loader);
+        if(result != vk::Result::eSuccess) {
+            return vk::Pipeline {};
+        }
+        return pipeline;
+    });
+}
+
+void PipelineCache::wait() {
+    m_jobSystem->wait(m_counter);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "jobsystem.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+class PipelineHandle final {
+
+    private:
+        struct State {
+            std::atomic<bool>           ready           {};
+            vk::Pipeline                pipeline        {};
+        };
+
+    private:
+        std::shared_ptr<State>          m_state                     {};
+
+    private:
+        friend class PipelineCache;
+
+    public:
+        bool ready() const;
+        vk::Pipeline get() const;
+        vk::Pipeline getOr(vk::Pipeline placeholder) const;
+};
+
+// vk::PipelineCache persisted to disk. The file name is keyed by vendor ID,
+// device ID and pipelineCacheUUID, and the header is validated again on load.
+class PipelineCache final {
+
+    public:
+        using Builder = std::function<vk::Pipeline(vk::Device device, vk::PipelineCache cache)>;
+
+    private:
+        vk::Device                                      m_device            {};
+        vk::PipelineCache                               m_cache             {};
+        JobSystem*                                      m_jobSystem         {};
+        JobCounter                                      m_counter           {};
+        std::filesystem::path                           m_path              {};
+        uint32_t                                        m_vendorID          {};
+        uint32_t                                        m_deviceID          {};
+        std::array<uint8_t, VK_UUID_SIZE>               m_uuid              {};
+        std::vector<std::shared_ptr<PipelineHandle::State>> m_pipelines     {};
+        std::mutex                                      m_mutex             {};
+
+    private:
+        std::vector<uint8_t> load() const;
+        bool validate(std::vector<uint8_t> const& data) const;
+
+    public:
+        void create(vk::PhysicalDevice physicalDevice, vk::Device device, JobSystem& jobSystem, std::filesystem::path const& directory, vk::DispatchLoaderDynamic const& loader);
+        void save(vk::DispatchLoaderDynamic const& loader);
+        void destroy(vk::DispatchLoaderDynamic const& loader);
+
+        vk::PipelineCache cache() const;
+
+        PipelineHandle compile(Builder builder);
+        PipelineHandle compileCompute(vk::ShaderModule shaderModule, vk::PipelineLayout layout, vk::DispatchLoaderDynamic const& loader);
+        void wait();
+};
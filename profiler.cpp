@@ -0,0 +1,264 @@
+#include "profiler.hpp"
+
+#include <stdexcept>
+
+namespace {
+
+    void writeString(std::ostream& stream, std::string_view text) {
+
+        stream << '"';
+        for(char c : text) {
+            if(c == '"' || c == '\\') {
+                stream << '\\' << c;
+            } else if(static_cast<unsigned char>(c) < 0x20) {
+                stream << ' ';
+            } else {
+                stream << c;
+            }
+        }
+        stream << '"';
+    }
+}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::ThreadBuffer& Profiler::threadBuffer() {
+
+    // Buffers outlive their threads so a capture can still be exported after
+    // a worker has exited.
+    thread_local ThreadBuffer* buffer = nullptr;
+    if(buffer == nullptr) {
+        std::lock_guard lock(m_mutex);
+        m_threads.push_back(std::make_unique<ThreadBuffer>());
+        buffer = m_threads.back().get();
+        buffer->index = static_cast<uint32_t>(m_threads.size() - 1);
+        buffer->name = "thread " + std::to_string(buffer->index);
+    }
+    return *buffer;
+}
+
+void Profiler::beginCapture() {
+    clear();
+    m_capturing.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::endCapture() {
+    m_capturing.store(false, std::memory_order_relaxed);
+}
+
+bool Profiler::capturing() const {
+    return m_capturing.load(std::memory_order_relaxed);
+}
+
+void Profiler::clear() {
+
+    std::lock_guard lock(m_mutex);
+    for(auto& thread : m_threads) {
+        std::lock_guard threadLock(thread->mutex);
+        thread->zones.clear();
+        thread->dropped = 0;
+    }
+    m_gpuZones.clear();
+}
+
+void Profiler::setThreadName(std::string name) {
+
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard lock(buffer.mutex);
+    buffer.name = std::move(name);
+}
+
+void Profiler::record(char const* name, uint64_t begin, uint64_t end) {
+
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard lock(buffer.mutex);
+    if(buffer.zones.size() == ZonesPerThread) {
+        buffer.dropped++;
+        return;
+    }
+    buffer.zones.push_back(Zone { .name = name, .begin = begin, .end = end });
+}
+
+void Profiler::recordGpu(std::string const& name, uint64_t begin, uint64_t end) {
+
+    std::lock_guard lock(m_mutex);
+    m_gpuZones.push_back(GpuZone { .name = name, .begin = begin, .end = end });
+}
+
+void Profiler::writeChromeTrace(std::ostream& stream) const {
+
+    std::lock_guard lock(m_mutex);
+
+    bool first = true;
+    auto const separator = [&stream, &first]() {
+        stream << (first ? "" : ",\n");
+        first = false;
+    };
+
+    auto const event = [&stream, &separator](std::string_view name, uint32_t pid, uint32_t tid, uint64_t begin, uint64_t end) {
+        separator();
+        stream << "{\"name\":";
+        writeString(stream, name);
+        stream << ",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid
+               << ",\"ts\":" << begin / 1000.0 << ",\"dur\":" << (end > begin ? end - begin : 0) / 1000.0 << "}";
+    };
+
+    auto const metadata = [&stream, &separator](char const* kind, uint32_t pid, uint32_t tid, std::string_view name) {
+        separator();
+        stream << "{\"name\":\"" << kind << "\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"args\":{\"name\":";
+        writeString(stream, name);
+        stream << "}}";
+    };
+
+    stream << "{\"traceEvents\":[\n";
+
+    metadata("process_name", 0, 0, "CPU");
+    metadata("process_name", 1, 0, "GPU");
+    metadata("thread_name", 1, 0, "graphics queue");
+
+    for(auto const& thread : m_threads) {
+        std::lock_guard threadLock(thread->mutex);
+        metadata("thread_name", 0, thread->index, thread->dropped == 0 ? thread->name : thread->name + " (" + std::to_string(thread->dropped) + " zones dropped)");
+        for(auto const& zone : thread->zones) {
+            event(zone.name, 0, thread->index, zone.begin, zone.end);
+        }
+    }
+
+    for(auto const& zone : m_gpuZones) {
+        event(zone.name, 1, 0, zone.begin, zone.end);
+    }
+
+    stream << "\n]}\n";
+}
+
+void GpuProfiler::create(vk::Device device, uint32_t frameCount, uint32_t timestampValidBits, double timestampPeriod, vk::DispatchLoaderDynamic const& loader) {
+
+    m_device = device;
+    m_timestampMask = timestampValidBits >= 64 ? ~uint64_t{0} : (uint64_t{1} << timestampValidBits) - 1;
+    m_timestampPeriod = timestampPeriod;
+    m_frames.resize(frameCount);
+
+    vk::QueryPoolCreateInfo const queryPoolCreateInfo
+    {
+        .sType = vk::StructureType::eQueryPoolCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .queryType = vk::QueryType::eTimestamp,
+        .queryCount = 1 + 2 * MaxZones,
+        .pipelineStatistics = {}
+    };
+
+    for(auto& frame : m_frames) {
+        vk::Result result = m_device.createQueryPool(&queryPoolCreateInfo, nullptr, &frame.queryPool, loader);
+        if(result != vk::Result::eSuccess) {
+            throw std::runtime_error("Error: GpuProfiler::create()");
+        }
+        frame.zones.reserve(MaxZones);
+    }
+}
+
+void GpuProfiler::destroy(vk::DispatchLoaderDynamic const& loader) {
+
+    for(auto& frame : m_frames) {
+        if(frame.queryPool) m_device.destroyQueryPool(frame.queryPool, nullptr, loader);
+    }
+    m_frames.clear();
+}
+
+void GpuProfiler::collect(uint32_t frameIndex, vk::DispatchLoaderDynamic const& loader) {
+
+    if(frameIndex >= m_frames.size()) {
+        return;
+    }
+
+    Frame& frame = m_frames[frameIndex];
+    if(!frame.pending) {
+        return;
+    }
+    frame.pending = false;
+
+    uint32_t const queryCount = 1 + 2 * static_cast<uint32_t>(frame.zones.size());
+    std::vector<uint64_t> timestamps(queryCount);
+
+    vk::Result result = m_device.getQueryPoolResults(frame.queryPool, 0, queryCount, timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), vk::QueryResultFlagBits::e64, loader);
+    if(result != vk::Result::eSuccess) {
+        return;
+    }
+
+    auto const toCpu = [this, &frame, origin = timestamps[0]](uint64_t timestamp) {
+        uint64_t const ticks = ((timestamp & m_timestampMask) - (origin & m_timestampMask)) & m_timestampMask;
+        return frame.submitTime + static_cast<uint64_t>(ticks * m_timestampPeriod);
+    };
+
+    Profiler& profiler = Profiler::instance();
+    for(uint32_t zone = 0; zone < frame.zones.size(); zone++) {
+        profiler.recordGpu(frame.zones[zone], toCpu(timestamps[1 + 2 * zone]), toCpu(timestamps[2 + 2 * zone]));
+    }
+}
+
+void GpuProfiler::beginFrame(uint32_t frameIndex, vk::CommandBuffer commandBuffer, vk::DispatchLoaderDynamic const& loader) {
+
+    m_current = frameIndex;
+    m_recording = frameIndex < m_frames.size() && Profiler::instance().capturing();
+    if(!m_recording) {
+        return;
+    }
+
+    Frame& frame = m_frames[frameIndex];
+    frame.zones.clear();
+    commandBuffer.resetQueryPool(frame.queryPool, 0, 1 + 2 * MaxZones, loader);
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.queryPool, 0, loader);
+}
+
+void GpuProfiler::endFrame(uint64_t submitTime) {
+
+    if(!m_recording) {
+        return;
+    }
+
+    Frame& frame = m_frames[m_current];
+    frame.submitTime = submitTime;
+    frame.pending = true;
+    m_recording = false;
+}
+
+uint32_t GpuProfiler::begin(vk::CommandBuffer commandBuffer, std::string_view name, vk::DispatchLoaderDynamic const& loader) {
+
+    uint32_t zone = InvalidZone;
+
+    if(m_recording && m_frames[m_current].zones.size() < MaxZones) {
+        Frame& frame = m_frames[m_current];
+        zone = static_cast<uint32_t>(frame.zones.size());
+        frame.zones.emplace_back(name);
+        commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.queryPool, 1 + 2 * zone, loader);
+    }
+
+    if(loader.vkCmdBeginDebugUtilsLabelEXT) {
+        std::string const label(name);
+
+        vk::DebugUtilsLabelEXT const debugUtilsLabel
+        {
+            .sType = vk::StructureType::eDebugUtilsLabelEXT,
+            .pNext = {},
+            .pLabelName = label.c_str(),
+            .color = {}
+        };
+        commandBuffer.beginDebugUtilsLabelEXT(&debugUtilsLabel, loader);
+    }
+
+    return zone;
+}
+
+void GpuProfiler::end(vk::CommandBuffer commandBuffer, uint32_t zone, vk::DispatchLoaderDynamic const& loader) {
+
+    if(loader.vkCmdEndDebugUtilsLabelEXT) {
+        commandBuffer.endDebugUtilsLabelEXT(loader);
+    }
+
+    if(zone != InvalidZone && m_recording) {
+        commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_frames[m_current].queryPool, 2 + 2 * zone, loader);
+    }
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "frametimer.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+#ifndef ENGINE_PROFILING
+#define ENGINE_PROFILING 0
+#endif
+
+inline constexpr bool ProfilingEnabled = ENGINE_PROFILING != 0;
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if ENGINE_PROFILING
+#define PROFILE_ZONE(name) ProfileZone const PROFILE_CONCAT(profileZone, __LINE__) { name }
+#define PROFILE_GPU_ZONE(profiler, commandBuffer, name, loader) GpuProfileZone const PROFILE_CONCAT(gpuProfileZone, __LINE__) { profiler, commandBuffer, name, loader }
+#define PROFILE_THREAD(name) Profiler::instance().setThreadName(name)
+#define PROFILE_NAME_OBJECT(device, handle, name, loader) Profiler::setObjectName(device, handle, name, loader)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_GPU_ZONE(profiler, commandBuffer, name, loader) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_NAME_OBJECT(device, handle, name, loader) ((void)0)
+#endif
+
+// Process wide capture of CPU zones from every thread and of resolved GPU
+// zones. Recording is off until beginCapture(), so an idle profiler costs a
+// relaxed load per zone. Each thread appends to its own buffer; the buffer
+// lock is only contended while a capture is exported.
+class Profiler final {
+
+    public:
+        static constexpr std::size_t ZonesPerThread = 1 << 16;
+
+        struct Zone {
+            char const*                 name            {};
+            uint64_t                    begin           {};
+            uint64_t                    end             {};
+        };
+
+        struct GpuZone {
+            std::string                 name            {};
+            uint64_t                    begin           {};
+            uint64_t                    end             {};
+        };
+
+    private:
+        struct ThreadBuffer {
+            std::mutex                  mutex           {};
+            std::vector<Zone>           zones           {};
+            std::string                 name            {};
+            uint32_t                    index           {};
+            uint64_t                    dropped         {};
+        };
+
+    private:
+        std::atomic<bool>                           m_capturing             {};
+        mutable std::mutex                          m_mutex                 {};
+        std::vector<std::unique_ptr<ThreadBuffer>>  m_threads               {};
+        std::vector<GpuZone>                        m_gpuZones              {};
+
+    private:
+        ThreadBuffer& threadBuffer();
+
+    public:
+        static Profiler& instance();
+
+        template<typename Handle>
+        static void setObjectName(vk::Device device, Handle handle, char const* name, vk::DispatchLoaderDynamic const& loader) {
+
+            if(!handle || !loader.vkSetDebugUtilsObjectNameEXT) {
+                return;
+            }
+
+            auto const native = static_cast<typename Handle::CType>(handle);
+            uint64_t objectHandle;
+            if constexpr(std::is_pointer_v<typename Handle::CType>) {
+                objectHandle = static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(native));
+            } else {
+                objectHandle = static_cast<uint64_t>(native);
+            }
+
+            vk::DebugUtilsObjectNameInfoEXT const objectNameInfo
+            {
+                .sType = vk::StructureType::eDebugUtilsObjectNameInfoEXT,
+                .pNext = {},
+                .objectType = Handle::objectType,
+                .objectHandle = objectHandle,
+                .pObjectName = name
+            };
+
+            static_cast<void>(device.setDebugUtilsObjectNameEXT(&objectNameInfo, loader));
+        }
+
+    public:
+        void beginCapture();
+        void endCapture();
+        bool capturing() const;
+        void clear();
+
+        void setThreadName(std::string name);
+        void record(char const* name, uint64_t begin, uint64_t end);
+        void recordGpu(std::string const& name, uint64_t begin, uint64_t end);
+
+        void writeChromeTrace(std::ostream& stream) const;
+};
+
+class ProfileZone final {
+
+    private:
+        char const*                     m_name                      {};
+        uint64_t                        m_begin                     {};
+
+    public:
+        explicit ProfileZone(char const* name) : m_name(Profiler::instance().capturing() ? name : nullptr) {
+            if(m_name) m_begin = FrameTimer::now();
+        }
+
+        ~ProfileZone() {
+            if(m_name) Profiler::instance().record(m_name, m_begin, FrameTimer::now());
+        }
+
+        ProfileZone(ProfileZone const&) = delete;
+        ProfileZone& operator = (ProfileZone const&) = delete;
+};
+
+// Timestamp queries and debug-utils labels around regions of the frame
+// command buffer. One query pool per frame in flight; collect() resolves a
+// frame once its timeline value has been reached. GPU time is anchored at the
+// CPU time of the submit, the same approximation FrameTimer makes.
+class GpuProfiler final {
+
+    public:
+        static constexpr uint32_t MaxZones = 128;
+        static constexpr uint32_t InvalidZone = UINT32_MAX;
+
+    private:
+        struct Frame {
+            vk::QueryPool               queryPool       {};
+            std::vector<std::string>    zones           {};
+            uint64_t                    submitTime      {};
+            bool                        pending         {};
+        };
+
+    private:
+        vk::Device                      m_device                    {};
+        std::vector<Frame>              m_frames                    {};
+        uint32_t                        m_current                   {};
+        uint64_t                        m_timestampMask             {};
+        double                          m_timestampPeriod           {};
+        bool                            m_recording                 {};
+
+    public:
+        void create(vk::Device device, uint32_t frameCount, uint32_t timestampValidBits, double timestampPeriod, vk::DispatchLoaderDynamic const& loader);
+        void destroy(vk::DispatchLoaderDynamic const& loader);
+
+        void collect(uint32_t frame, vk::DispatchLoaderDynamic const& loader);
+        void beginFrame(uint32_t frame, vk::CommandBuffer commandBuffer, vk::DispatchLoaderDynamic const& loader);
+        void endFrame(uint64_t submitTime);
+
+        uint32_t begin(vk::CommandBuffer commandBuffer, std::string_view name, vk::DispatchLoaderDynamic const& loader);
+        void end(vk::CommandBuffer commandBuffer, uint32_t zone, vk::DispatchLoaderDynamic const& loader);
+};
+
+class GpuProfileZone final {
+
+    private:
+        GpuProfiler*                        m_profiler              {};
+        vk::CommandBuffer                   m_commandBuffer         {};
+        vk::DispatchLoaderDynamic const*    m_loader                {};
+        uint32_t                            m_zone                  {GpuProfiler::InvalidZone};
+
+    public:
+        GpuProfileZone(GpuProfiler& profiler, vk::CommandBuffer commandBuffer, std::string_view name, vk::DispatchLoaderDynamic const& loader)
+            : m_profiler(&profiler), m_commandBuffer(commandBuffer), m_loader(&loader), m_zone(profiler.begin(commandBuffer, name, loader)) {}
+
+        ~GpuProfileZone() {
+            m_profiler->end(m_commandBuffer, m_zone, *m_loader);
+        }
+
+        GpuProfileZone(GpuProfileZone const&) = delete;
+        GpuProfileZone& operator = (GpuProfileZone const&) = delete;
+};
@@ -0,0 +1,455 @@
+#include "rendercontext.hpp"
+
+void RenderContext::loadVulkanLibrary() {
+
+    if(m_headless) {
+        m_library = std::make_shared<vk::DynamicLoader>();
+        m_loader.init(m_library->getProcAddress<PFN_vkGetInstanceProcAddr>("vkGetInstanceProcAddr"));
+        return;
+    }
+
+    SDL_InitSubSystem(SDL_INIT_VIDEO);
+    SDL_Vulkan_LoadLibrary(nullptr);
+    m_loader.init(reinterpret_cast<PFN_vkGetInstanceProcAddr>(SDL_Vulkan_GetVkGetInstanceProcAddr()));
+
+    uint32_t requiredExtensionsCount;
+    auto requiredExtensions = SDL_Vulkan_GetInstanceExtensions(&requiredExtensionsCount);
+    m_windowExtensions.assign(requiredExtensions, requiredExtensions + requiredExtensionsCount);
+}
+
+void RenderContext::createInstance() {
+
+    m_version = vk::enumerateInstanceVersion(m_loader);
+    std::cout << VK_VERSION_MAJOR(m_version) << "." << VK_VERSION_MINOR(m_version) << "." << VK_VERSION_PATCH(m_version) << std::endl;
+
+    vk::ApplicationInfo applicationInfo {};
+    applicationInfo.setApiVersion(m_version);
+
+    std::vector<const char*> instanceExtensions = { VK_EXT_DEBUG_UTILS_EXTENSION_NAME };
+    instanceExtensions.insert(instanceExtensions.end(), m_windowExtensions.begin(), m_windowExtensions.end());
+
+    std::vector<const char*> instanceLayers;
+    for(auto const& layer : vk::enumerateInstanceLayerProperties(m_loader)) {
+        if(std::strcmp(layer.layerName, "VK_LAYER_KHRONOS_validation") == 0) {
+            instanceLayers.push_back("VK_LAYER_KHRONOS_validation");
+        }
+    }
+
+    vk::InstanceCreateInfo instanceCreateInfo {};
+    instanceCreateInfo.setPApplicationInfo(&applicationInfo);
+    instanceCreateInfo.setPEnabledLayerNames(instanceLayers);
+    instanceCreateInfo.setPEnabledExtensionNames(instanceExtensions);
+
+    vk::Result result = vk::createInstance(&instanceCreateInfo, nullptr, &m_instance, m_loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: RenderContext::createInstance()");
+    }
+    m_loader.init(m_instance);
+}
+
+void RenderContext::selectPhysicalDevice() {
+
+    auto m_physicalDevices = m_instance.enumeratePhysicalDevices(m_loader);
+    if(m_physicalDevices.empty()) {
+        throw std::runtime_error("Error: RenderContext::selectPhysicalDevice() no physical device");
+    }
+
+    auto const selectionPath = m_cacheDirectory / "device.bin";
+    if(auto const cached = DeviceSelection::load(selectionPath)) {
+        for(auto const& physicalDevice : m_physicalDevices) {
+            uint32_t const queueFamilyCount = static_cast<uint32_t>(physicalDevice.getQueueFamilyProperties(m_loader).size());
+            if(cached->matches(DeviceSelection::identify(physicalDevice, m_loader))
+                && cached->graphicsQueueFamilyIndex < queueFamilyCount
+                && cached->transferQueueFamilyIndex < queueFamilyCount
+                && cached->computeQueueFamilyIndex < queueFamilyCount) {
+                m_physicalDevice = physicalDevice;
+                m_graphicsQueueFamilyIndex = cached->graphicsQueueFamilyIndex;
+                m_transferQueueFamilyIndex = cached->transferQueueFamilyIndex;
+                m_computeQueueFamilyIndex = cached->computeQueueFamilyIndex;
+                return;
+            }
+        }
+    }
+
+    auto const rank = [this](const auto& m_physicalDevice) {
+        switch(m_physicalDevice.getProperties(m_loader).deviceType) {
+            case vk::PhysicalDeviceType::eDiscreteGpu:      return 0;
+            case vk::PhysicalDeviceType::eIntegratedGpu:    return 1;
+            case vk::PhysicalDeviceType::eVirtualGpu:       return 2;
+            case vk::PhysicalDeviceType::eCpu:              return 3;
+            default:                                        return 4;
+        }
+    };
+
+    m_physicalDevice = *std::ranges::min_element(m_physicalDevices, {}, rank);
+
+    auto queueFamilyProperties = m_physicalDevice.getQueueFamilyProperties(m_loader);
+    
+    auto iter = std::find_if(queueFamilyProperties.begin(), queueFamilyProperties.end(), [](const auto& properties) {
+        return properties.queueFlags & vk::QueueFlagBits::eGraphics;
+    });
+
+    m_graphicsQueueFamilyIndex = static_cast<uint32_t>(std::distance(queueFamilyProperties.begin(), iter));
+
+    auto const transferOnly = [](const auto& properties) {
+        return (properties.queueFlags & vk::QueueFlagBits::eTransfer) && !(properties.queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute));
+    };
+    auto const transferWithoutGraphics = [](const auto& properties) {
+        return (properties.queueFlags & (vk::QueueFlagBits::eTransfer | vk::QueueFlagBits::eCompute)) && !(properties.queueFlags & vk::QueueFlagBits::eGraphics);
+    };
+
+    auto transferIter = std::find_if(queueFamilyProperties.begin(), queueFamilyProperties.end(), transferOnly);
+    if(transferIter == queueFamilyProperties.end()) {
+        transferIter = std::find_if(queueFamilyProperties.begin(), queueFamilyProperties.end(), transferWithoutGraphics);
+    }
+    m_transferQueueFamilyIndex = transferIter != queueFamilyProperties.end() ? static_cast<uint32_t>(std::distance(queueFamilyProperties.begin(), transferIter)) : m_graphicsQueueFamilyIndex;
+
+    auto const asyncCompute = [this, &queueFamilyProperties](const auto& properties) {
+        auto const family = static_cast<uint32_t>(&properties - queueFamilyProperties.data());
+        return (properties.queueFlags & vk::QueueFlagBits::eCompute) && !(properties.queueFlags & vk::QueueFlagBits::eGraphics) && family != m_transferQueueFamilyIndex;
+    };
+    auto const computeWithoutGraphics = [](const auto& properties) {
+        return (properties.queueFlags & vk::QueueFlagBits::eCompute) && !(properties.queueFlags & vk::QueueFlagBits::eGraphics);
+    };
+
+    auto computeIter = std::find_if(queueFamilyProperties.begin(), queueFamilyProperties.end(), asyncCompute);
+    if(computeIter == queueFamilyProperties.end()) {
+        computeIter = std::find_if(queueFamilyProperties.begin(), queueFamilyProperties.end(), computeWithoutGraphics);
+    }
+    m_computeQueueFamilyIndex = computeIter != queueFamilyProperties.end() ? static_cast<uint32_t>(std::distance(queueFamilyProperties.begin(), computeIter)) : m_graphicsQueueFamilyIndex;
+
+    DeviceSelection selection = DeviceSelection::identify(m_physicalDevice, m_loader);
+    selection.graphicsQueueFamilyIndex = m_graphicsQueueFamilyIndex;
+    selection.transferQueueFamilyIndex = m_transferQueueFamilyIndex;
+    selection.computeQueueFamilyIndex = m_computeQueueFamilyIndex;
+    selection.save(selectionPath);
+}
+
+void RenderContext::createDevice() {
+
+    selectPhysicalDevice();
+
+    std::cout << m_physicalDevice.getProperties(m_loader).deviceName << std::endl;
+
+    auto const queueFamilyProperties = m_physicalDevice.getQueueFamilyProperties(m_loader);
+    m_timestampValidBits = queueFamilyProperties[m_graphicsQueueFamilyIndex].timestampValidBits;
+    m_timestampPeriod = m_physicalDevice.getProperties(m_loader).limits.timestampPeriod;
+
+    auto const availableExtensions = m_physicalDevice.enumerateDeviceExtensionProperties(nullptr, m_loader);
+    auto const hasExtension = [&availableExtensions](char const* name) {
+        return std::ranges::any_of(availableExtensions, [name](auto const& extension) { return std::strcmp(extension.extensionName, name) == 0; });
+    };
+
+    uint32_t const apiVersion = std::min(m_version, m_physicalDevice.getProperties(m_loader).apiVersion);
+    bool const dynamicRenderingExtensions = apiVersion < VK_API_VERSION_1_3
+        && hasExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)
+        && hasExtension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+
+    m_externalMemoryHost = hasExtension(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+    if(m_externalMemoryHost) {
+        vk::PhysicalDeviceExternalMemoryHostPropertiesEXT externalMemoryHostProperties {};
+        vk::PhysicalDeviceProperties2 properties { .sType = vk::StructureType::ePhysicalDeviceProperties2, .pNext = &externalMemoryHostProperties, .properties = {} };
+        m_physicalDevice.getProperties2(&properties, m_loader);
+        m_hostPointerAlignment = externalMemoryHostProperties.minImportedHostPointerAlignment;
+    }
+
+    vk::PhysicalDeviceVulkan12Features supportedVulkan12Features {};
+    vk::PhysicalDeviceVulkan13Features supportedVulkan13Features {};
+    vk::PhysicalDeviceDynamicRenderingFeatures supportedDynamicRenderingFeatures {};
+    vk::PhysicalDeviceSynchronization2Features supportedSynchronization2Features {};
+
+    if(apiVersion >= VK_API_VERSION_1_3) {
+        supportedVulkan12Features.setPNext(&supportedVulkan13Features);
+    } else if(dynamicRenderingExtensions) {
+        supportedVulkan12Features.setPNext(&supportedDynamicRenderingFeatures);
+        supportedDynamicRenderingFeatures.setPNext(&supportedSynchronization2Features);
+    }
+
+    vk::PhysicalDeviceFeatures2 supportedFeatures
+    {
+        .sType = vk::StructureType::ePhysicalDeviceFeatures2,
+        .pNext = &supportedVulkan12Features,
+        .features = {}
+    };
+    m_physicalDevice.getFeatures2(&supportedFeatures, m_loader);
+
+    if(apiVersion < VK_API_VERSION_1_2 || !supportedVulkan12Features.timelineSemaphore) {
+        throw std::runtime_error("Error: RenderContext::createDevice() timeline semaphores are not supported");
+    }
+
+    if(apiVersion >= VK_API_VERSION_1_3) {
+        m_dynamicRendering = supportedVulkan13Features.dynamicRendering && supportedVulkan13Features.synchronization2;
+    } else {
+        m_dynamicRendering = dynamicRenderingExtensions && supportedDynamicRenderingFeatures.dynamicRendering && supportedSynchronization2Features.synchronization2;
+    }
+
+    m_descriptorIndexing = BindlessTable::supported(supportedVulkan12Features);
+
+    m_indirectDrawing = supportedFeatures.features.multiDrawIndirect
+        && supportedFeatures.features.drawIndirectFirstInstance
+        && supportedVulkan12Features.drawIndirectCount;
+
+    vk::PhysicalDeviceVulkan12Features vulkan12Features {};
+    vulkan12Features.setTimelineSemaphore(vk::True);
+    vulkan12Features.setDrawIndirectCount(m_indirectDrawing);
+    if(m_descriptorIndexing) {
+        BindlessTable::enable(vulkan12Features);
+    }
+
+    vk::PhysicalDeviceVulkan13Features vulkan13Features {};
+    vk::PhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures {};
+    vk::PhysicalDeviceSynchronization2Features synchronization2Features {};
+
+    if(m_dynamicRendering && apiVersion >= VK_API_VERSION_1_3) {
+        vulkan13Features.setDynamicRendering(vk::True);
+        vulkan13Features.setSynchronization2(vk::True);
+        vulkan12Features.setPNext(&vulkan13Features);
+    } else if(m_dynamicRendering) {
+        dynamicRenderingFeatures.setDynamicRendering(vk::True);
+        synchronization2Features.setSynchronization2(vk::True);
+        dynamicRenderingFeatures.setPNext(&synchronization2Features);
+        vulkan12Features.setPNext(&dynamicRenderingFeatures);
+    }
+
+    std::vector<uint32_t> queueCounts(queueFamilyProperties.size());
+    auto const claimQueue = [&queueCounts, &queueFamilyProperties](uint32_t family) {
+        uint32_t const index = std::min(queueCounts[family], queueFamilyProperties[family].queueCount - 1);
+        queueCounts[family] = std::max(queueCounts[family], index + 1);
+        return index;
+    };
+
+    uint32_t const graphicsQueueIndex = claimQueue(m_graphicsQueueFamilyIndex);
+    uint32_t const transferQueueIndex = claimQueue(m_transferQueueFamilyIndex);
+    uint32_t const computeQueueIndex = claimQueue(m_computeQueueFamilyIndex);
+
+    std::vector<float> const priorities(std::ranges::max(queueCounts), 1.0f);
+    std::vector<const char*> deviceExtensions;
+    if(!m_headless) {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+
+    if(m_dynamicRendering && apiVersion < VK_API_VERSION_1_3) {
+        deviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    }
+
+    if(m_externalMemoryHost) {
+        deviceExtensions.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+    }
+
+    vk::PhysicalDeviceFeatures features {};
+    features.setMultiDrawIndirect(m_indirectDrawing);
+    features.setDrawIndirectFirstInstance(m_indirectDrawing);
+
+    std::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos;
+    for(uint32_t family = 0; family < queueCounts.size(); family++) {
+        if(queueCounts[family] == 0) {
+            continue;
+        }
+
+        deviceQueueCreateInfos.push_back(vk::DeviceQueueCreateInfo
+        {
+            .sType = vk::StructureType::eDeviceQueueCreateInfo,
+            .pNext = {},
+            .flags = {}, 
+            .queueFamilyIndex = family,
+            .queueCount = queueCounts[family],
+            .pQueuePriorities = priorities.data()
+        });
+    }
+    
+    vk::DeviceCreateInfo deviceCreateInfo 
+    {
+        .sType = vk::StructureType::eDeviceCreateInfo,
+        .pNext = &vulkan12Features,
+        .flags = {},
+        .queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCreateInfos.size()),
+        .pQueueCreateInfos = deviceQueueCreateInfos.data(),
+        .enabledLayerCount = {},
+        .ppEnabledLayerNames = {},
+        .enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
+        .ppEnabledExtensionNames = deviceExtensions.data(),
+        .pEnabledFeatures = &features,
+    };
+
+    vk::Result result = m_physicalDevice.createDevice(&deviceCreateInfo, nullptr, &m_device, m_loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: RenderContext::createDevice()");
+    }
+    m_loader.init(m_device);
+    m_deviceDispatch.init(m_device, m_loader.vkGetDeviceProcAddr);
+
+    m_queue = m_device.getQueue(m_graphicsQueueFamilyIndex, graphicsQueueIndex, m_loader);
+    m_transferQueue = m_device.getQueue(m_transferQueueFamilyIndex, transferQueueIndex, m_loader);
+    m_computeQueue = m_device.getQueue(m_computeQueueFamilyIndex, computeQueueIndex, m_loader);
+}
+
+// Without dedicated families the transfer and compute queues may be the
+// graphics queue itself. vkQueueSubmit and vkQueuePresentKHR need external
+// synchronization per VkQueue, so aliased queues share one mutex.
+std::mutex& RenderContext::queueMutex(vk::Queue queue) {
+
+    if(queue == m_queue) {
+        return m_queueMutex;
+    }
+
+    if(queue == m_transferQueue) {
+        return m_transferQueueMutex;
+    }
+
+    return m_computeQueueMutex;
+}
+
+void RenderContext::createAllocator() {
+    m_allocator->create(m_physicalDevice, m_device, m_loader);
+}
+
+void RenderContext::createUploader() {
+
+    auto const limits = m_physicalDevice.getProperties(m_loader).limits;
+    m_uploader->create(m_device, *m_allocator, m_transferQueue, queueMutex(m_transferQueue), m_transferQueueFamilyIndex, m_graphicsQueueFamilyIndex, limits.optimalBufferCopyOffsetAlignment, m_loader);
+}
+
+void RenderContext::createComputeQueue() {
+    m_compute->create(m_device, m_computeQueue, queueMutex(m_computeQueue), m_computeQueueFamilyIndex, m_loader);
+}
+
+void RenderContext::createBindlessTable() {
+
+    if(!m_descriptorIndexing) {
+        return;
+    }
+
+    m_bindlessTable->create(m_physicalDevice, m_device, m_loader);
+}
+
+void RenderContext::createJobSystem() {
+    m_jobSystem = std::make_shared<JobSystem>();
+}
+
+void RenderContext::createPipelineCache() {
+    m_pipelineCache->create(m_physicalDevice, m_device, *m_jobSystem, m_cacheDirectory, m_loader);
+}
+
+void RenderContext::createTextureLoader() {
+    m_textureLoader->create(m_device, m_physicalDevice, *m_allocator, *m_uploader, m_externalMemoryHost ? m_hostPointerAlignment : 0);
+}
+
+void RenderContext::createTimeline() {
+    m_graphicsTimeline.create(m_device, m_loader);
+}
+
+void RenderContext::attach() {
+    m_windowCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RenderContext::detach() {
+    m_windowCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+uint32_t RenderContext::windowCount() const {
+    return m_windowCount.load(std::memory_order_relaxed);
+}
+
+bool RenderContext::isHeadless() const {
+    return m_headless;
+}
+
+bool RenderContext::usesDynamicRendering() const {
+    return m_dynamicRendering;
+}
+
+bool RenderContext::supportsIndirectDrawing() const {
+    return m_indirectDrawing;
+}
+
+uint32_t RenderContext::getTimestampValidBits() const {
+    return m_timestampValidBits;
+}
+
+double RenderContext::getTimestampPeriod() const {
+    return m_timestampPeriod;
+}
+
+vk::DispatchLoaderDynamic const& RenderContext::getLoader() const {
+    return m_loader;
+}
+
+DeviceDispatch const& RenderContext::getDeviceDispatch() const {
+    return m_deviceDispatch;
+}
+
+vk::Instance RenderContext::getInstance() const {
+    return m_instance;
+}
+
+vk::PhysicalDevice RenderContext::getPhysicalDevice() const {
+    return m_physicalDevice;
+}
+
+vk::Device RenderContext::getDevice() const {
+    return m_device;
+}
+
+vk::Queue RenderContext::getQueue() const {
+    return m_queue;
+}
+
+uint32_t RenderContext::getQueueFamilyIndex() const {
+    return m_graphicsQueueFamilyIndex;
+}
+
+std::mutex& RenderContext::getQueueMutex() {
+    return m_queueMutex;
+}
+
+Timeline& RenderContext::getGraphicsTimeline() {
+    return m_graphicsTimeline;
+}
+
+Allocator& RenderContext::getAllocator() {
+    return *m_allocator;
+}
+
+Uploader& RenderContext::getUploader() {
+    return *m_uploader;
+}
+
+ComputeQueue& RenderContext::getComputeQueue() {
+    return *m_compute;
+}
+
+BindlessTable& RenderContext::getBindlessTable() {
+    return *m_bindlessTable;
+}
+
+JobSystem& RenderContext::getJobSystem() {
+    return *m_jobSystem;
+}
+
+PipelineCache& RenderContext::getPipelineCache() {
+    return *m_pipelineCache;
+}
+
+TextureLoader& RenderContext::getTextureLoader() {
+    return *m_textureLoader;
+}
+
+RenderContext::~RenderContext() {
+
+    if(m_device) m_device.waitIdle(m_loader);
+
+    if(m_device) m_graphicsTimeline.destroy(m_device, m_loader);
+    if(m_device) m_pipelineCache->destroy(m_loader);
+    if(m_device) m_bindlessTable->destroy(m_loader);
+    if(m_device) m_compute->destroy(m_loader);
+    if(m_device) m_textureLoader->destroy(m_loader);
+    if(m_device) m_uploader->destroy(m_loader);
+    if(m_device) m_allocator->destroy(m_loader);
+
+    if(m_device) m_device.destroy(nullptr, m_loader);
+    if(m_instance) m_instance.destroy(nullptr, m_loader);
+
+    if(!m_headless) SDL_Vulkan_UnloadLibrary();
+    SDL_Quit();
+}
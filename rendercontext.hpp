@@ -0,0 +1,125 @@
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "allocator.hpp"
+#include "bindless.hpp"
+#include "compute.hpp"
+#include "dispatch.hpp"
+#include "jobsystem.hpp"
+#include "pipelinecache.hpp"
+#include "startup.hpp"
+#include "textureloader.hpp"
+#include "timeline.hpp"
+#include "uploader.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+#include "SDL3/SDL.h"
+#include "SDL3/SDL_vulkan.h"
+
+// Everything a window renders with that is not tied to its surface: the
+// instance, the device and its queues, and the subsystems built on them.
+// Windows share it through a shared_ptr and the last one releases it. All
+// windows of a context signal the same graphics timeline, so they must be
+// rendered from one thread (see Window::updateAll()).
+class RenderContext final {
+
+    private:
+        bool                            m_headless                  {false};
+        bool                            m_dynamicRendering          {false};
+        bool                            m_descriptorIndexing        {false};
+        bool                            m_indirectDrawing           {false};
+        bool                            m_externalMemoryHost        {false};
+        std::atomic<uint32_t>           m_windowCount               {};
+
+    private:
+        uint32_t                        m_graphicsQueueFamilyIndex  {};
+        uint32_t                        m_transferQueueFamilyIndex  {};
+        uint32_t                        m_computeQueueFamilyIndex   {};
+        uint32_t                        m_version                   {};
+        uint32_t                        m_timestampValidBits        {};
+        double                          m_timestampPeriod           {};
+        vk::DeviceSize                  m_hostPointerAlignment      {};
+        std::vector<const char*>        m_windowExtensions          {};
+        std::shared_ptr<vk::DynamicLoader> m_library                {};
+        vk::DispatchLoaderDynamic       m_loader                    {};
+        DeviceDispatch                  m_deviceDispatch            {};
+        vk::Instance                    m_instance                  {};
+        vk::PhysicalDevice              m_physicalDevice            {};
+        vk::Device                      m_device                    {};
+        vk::Queue                       m_queue                     {};
+        vk::Queue                       m_transferQueue             {};
+        vk::Queue                       m_computeQueue              {};
+        std::mutex                      m_queueMutex                {};
+        std::mutex                      m_transferQueueMutex        {};
+        std::mutex                      m_computeQueueMutex         {};
+        Timeline                        m_graphicsTimeline          {};
+        std::shared_ptr<Allocator>      m_allocator                 {std::make_shared<Allocator>()};
+        std::shared_ptr<Uploader>       m_uploader                  {std::make_shared<Uploader>()};
+        std::shared_ptr<ComputeQueue>   m_compute                   {std::make_shared<ComputeQueue>()};
+        std::shared_ptr<BindlessTable>  m_bindlessTable             {std::make_shared<BindlessTable>()};
+        std::shared_ptr<JobSystem>      m_jobSystem                 {};
+        std::shared_ptr<PipelineCache>  m_pipelineCache             {std::make_shared<PipelineCache>()};
+        std::shared_ptr<TextureLoader>  m_textureLoader             {std::make_shared<TextureLoader>()};
+        std::filesystem::path           m_cacheDirectory            {"cache"};
+
+    private:
+        void selectPhysicalDevice();
+        std::mutex& queueMutex(vk::Queue queue);
+
+    public:
+        void loadVulkanLibrary();
+        void createInstance();
+        void createDevice();
+        void createAllocator();
+        void createUploader();
+        void createComputeQueue();
+        void createBindlessTable();
+        void createJobSystem();
+        void createPipelineCache();
+        void createTextureLoader();
+        void createTimeline();
+
+    public:
+        explicit RenderContext(bool headless = false) : m_headless(headless) {}
+        RenderContext(RenderContext const&) = delete;
+        RenderContext& operator = (RenderContext const&) = delete;
+
+    public:
+        void attach();
+        void detach();
+        uint32_t windowCount() const;
+
+        bool isHeadless() const;
+        bool usesDynamicRendering() const;
+        bool supportsIndirectDrawing() const;
+        uint32_t getTimestampValidBits() const;
+        double getTimestampPeriod() const;
+        vk::DispatchLoaderDynamic const& getLoader() const;
+        DeviceDispatch const& getDeviceDispatch() const;
+        vk::Instance getInstance() const;
+        vk::PhysicalDevice getPhysicalDevice() const;
+        vk::Device getDevice() const;
+        vk::Queue getQueue() const;
+        uint32_t getQueueFamilyIndex() const;
+        std::mutex& getQueueMutex();
+        Timeline& getGraphicsTimeline();
+        Allocator& getAllocator();
+        Uploader& getUploader();
+        ComputeQueue& getComputeQueue();
+        BindlessTable& getBindlessTable();
+        JobSystem& getJobSystem();
+        PipelineCache& getPipelineCache();
+        TextureLoader& getTextureLoader();
+
+        ~RenderContext();
+};
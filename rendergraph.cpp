@@ -0,0 +1,579 @@
+#include "rendergraph.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+RenderGraph::PassBuilder::PassBuilder(RenderGraph& graph, uint32_t pass) : m_graph(graph), m_pass(pass) {
+}
+
+void RenderGraph::PassBuilder::use(Resource resource, Access const& access, bool write) {
+
+    if(resource >= m_graph.m_images.size()) {
+        throw std::runtime_error("Error: RenderGraph::PassBuilder::use() unknown resource");
+    }
+
+    auto& uses = m_graph.m_passes[m_pass].uses;
+    auto iter = std::ranges::find(uses, resource, &Use::resource);
+    if(iter == uses.end()) {
+        uses.push_back(Use { .resource = resource, .access = access, .write = write });
+        return;
+    }
+
+    if(iter->access.layout != access.layout) {
+        throw std::runtime_error("Error: RenderGraph::PassBuilder::use() conflicting layouts within one pass");
+    }
+    iter->access.stages |= access.stages;
+    iter->access.access |= access.access;
+    iter->write = iter->write || write;
+}
+
+void RenderGraph::PassBuilder::read(Resource resource, Access const& access) {
+    use(resource, access, false);
+}
+
+void RenderGraph::PassBuilder::write(Resource resource, Access const& access) {
+    use(resource, access, true);
+}
+
+void RenderGraph::PassBuilder::colorAttachment(Resource resource) {
+    write(resource, Access
+    {
+        .stages = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        .access = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
+        .layout = vk::ImageLayout::eColorAttachmentOptimal
+    });
+}
+
+void RenderGraph::PassBuilder::depthAttachment(Resource resource) {
+    write(resource, Access
+    {
+        .stages = vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+        .access = vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        .layout = vk::ImageLayout::eDepthStencilAttachmentOptimal
+    });
+}
+
+void RenderGraph::PassBuilder::sampled(Resource resource, vk::PipelineStageFlags stages) {
+    read(resource, Access { .stages = stages, .access = vk::AccessFlagBits::eShaderRead, .layout = vk::ImageLayout::eShaderReadOnlyOptimal });
+}
+
+void RenderGraph::PassBuilder::storageRead(Resource resource, vk::PipelineStageFlags stages) {
+    read(resource, Access { .stages = stages, .access = vk::AccessFlagBits::eShaderRead, .layout = vk::ImageLayout::eGeneral });
+}
+
+void RenderGraph::PassBuilder::storageWrite(Resource resource, vk::PipelineStageFlags stages) {
+    write(resource, Access { .stages = stages, .access = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite, .layout = vk::ImageLayout::eGeneral });
+}
+
+void RenderGraph::PassBuilder::transferSource(Resource resource) {
+    read(resource, Access { .stages = vk::PipelineStageFlagBits::eTransfer, .access = vk::AccessFlagBits::eTransferRead, .layout = vk::ImageLayout::eTransferSrcOptimal });
+}
+
+void RenderGraph::PassBuilder::transferDestination(Resource resource) {
+    write(resource, Access { .stages = vk::PipelineStageFlagBits::eTransfer, .access = vk::AccessFlagBits::eTransferWrite, .layout = vk::ImageLayout::eTransferDstOptimal });
+}
+
+void RenderGraph::PassBuilder::sideEffect() {
+    m_graph.m_passes[m_pass].sideEffect = true;
+}
+
+RenderGraph::Resource RenderGraph::importImage(std::string name, vk::Image image, vk::ImageView imageView, Access const& initial, Access const& final, vk::ImageAspectFlags aspect) {
+
+    m_images.push_back(Image
+    {
+        .name = std::move(name),
+        .imported = true,
+        .description = { .format = {}, .extent = {}, .usage = {}, .aspect = aspect },
+        .image = image,
+        .imageView = imageView,
+        .initial = initial,
+        .final = final
+    });
+    return static_cast<Resource>(m_images.size() - 1);
+}
+
+void RenderGraph::setImportedImage(Resource resource, vk::Image image, vk::ImageView imageView) {
+
+    Image& entry = m_images.at(resource);
+    if(!entry.imported) {
+        throw std::runtime_error("Error: RenderGraph::setImportedImage() resource is transient");
+    }
+    entry.image = image;
+    entry.imageView = imageView;
+}
+
+RenderGraph::Resource RenderGraph::createImage(std::string name, ImageDescription const& description) {
+
+    bool const backbufferSized = description.extent.width == 0 && description.extent.height == 0;
+
+    m_images.push_back(Image { .name = std::move(name), .imported = false, .backbufferSized = backbufferSized, .description = description });
+    if(backbufferSized) m_images.back().description.extent = m_backbufferExtent;
+
+    return static_cast<Resource>(m_images.size() - 1);
+}
+
+void RenderGraph::setBackbufferExtent(vk::Extent2D extent) {
+
+    m_backbufferExtent = extent;
+
+    for(auto& image : m_images) {
+        if(image.backbufferSized) image.description.extent = extent;
+    }
+}
+
+void RenderGraph::addPass(std::string name, Setup const& setup, Execute execute) {
+
+    m_passes.push_back(Pass { .name = std::move(name), .uses = {}, .execute = std::move(execute), .sideEffect = false });
+
+    PassBuilder builder(*this, static_cast<uint32_t>(m_passes.size() - 1));
+    setup(builder);
+}
+
+std::vector<bool> RenderGraph::cull() const {
+
+    std::vector<std::vector<uint32_t>> dependencies(m_passes.size());
+    std::vector<uint32_t> lastWriter(m_images.size(), UINT32_MAX);
+
+    for(uint32_t pass = 0; pass < m_passes.size(); pass++) {
+        for(auto const& use : m_passes[pass].uses) {
+            if(lastWriter[use.resource] != UINT32_MAX) {
+                dependencies[pass].push_back(lastWriter[use.resource]);
+            }
+        }
+        for(auto const& use : m_passes[pass].uses) {
+            if(use.write) lastWriter[use.resource] = pass;
+        }
+    }
+
+    std::vector<bool> live(m_passes.size());
+    std::vector<uint32_t> stack;
+
+    for(uint32_t pass = 0; pass < m_passes.size(); pass++) {
+        bool const writesImported = std::ranges::any_of(m_passes[pass].uses, [this](Use const& use) {
+            return use.write && m_images[use.resource].imported;
+        });
+        if(m_passes[pass].sideEffect || writesImported) {
+            live[pass] = true;
+            stack.push_back(pass);
+        }
+    }
+
+    while(!stack.empty()) {
+        uint32_t const pass = stack.back();
+        stack.pop_back();
+        for(uint32_t dependency : dependencies[pass]) {
+            if(!live[dependency]) {
+                live[dependency] = true;
+                stack.push_back(dependency);
+            }
+        }
+    }
+
+    return live;
+}
+
+void RenderGraph::createTransientImages(vk::DispatchLoaderDynamic const& loader) {
+
+    std::vector<Resource> transients;
+    std::vector<vk::MemoryRequirements> requirements(m_images.size());
+
+    for(Resource resource = 0; resource < m_images.size(); resource++) {
+
+        Image& image = m_images[resource];
+        if(image.imported || image.firstUse == UINT32_MAX) {
+            continue;
+        }
+
+        vk::ImageCreateInfo const imageCreateInfo
+        {
+            .sType = vk::StructureType::eImageCreateInfo,
+            .pNext = {},
+            .flags = {},
+            .imageType = vk::ImageType::e2D,
+            .format = image.description.format,
+            .extent = { image.description.extent.width, image.description.extent.height, 1 },
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = vk::SampleCountFlagBits::e1,
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = image.description.usage,
+            .sharingMode = vk::SharingMode::eExclusive,
+            .queueFamilyIndexCount = {},
+            .pQueueFamilyIndices = {},
+            .initialLayout = vk::ImageLayout::eUndefined
+        };
+
+        vk::Result result = m_device.createImage(&imageCreateInfo, nullptr, &image.image, loader);
+        if(result != vk::Result::eSuccess) {
+            throw std::runtime_error("Error: RenderGraph::createTransientImages()");
+        }
+
+        m_device.getImageMemoryRequirements(image.image, &requirements[resource], loader);
+        transients.push_back(resource);
+    }
+
+    std::ranges::sort(transients, std::greater {}, [&requirements](Resource resource) { return requirements[resource].size; });
+
+    for(Resource resource : transients) {
+
+        Image& image = m_images[resource];
+        vk::MemoryRequirements const& imageRequirements = requirements[resource];
+
+        auto const fits = [&](MemorySlot const& slot) {
+            if(!(slot.requirements.memoryTypeBits & imageRequirements.memoryTypeBits)) {
+                return false;
+            }
+            return std::ranges::none_of(slot.images, [&](Resource other) {
+                return m_images[other].firstUse <= image.lastUse && image.firstUse <= m_images[other].lastUse;
+            });
+        };
+
+        auto slot = std::ranges::find_if(m_slots, fits);
+        if(slot == m_slots.end()) {
+            m_slots.push_back(MemorySlot { .requirements = imageRequirements, .allocation = {}, .images = {} });
+            slot = std::prev(m_slots.end());
+        }
+
+        slot->requirements.size = std::max(slot->requirements.size, imageRequirements.size);
+        slot->requirements.alignment = std::max(slot->requirements.alignment, imageRequirements.alignment);
+        slot->requirements.memoryTypeBits &= imageRequirements.memoryTypeBits;
+        slot->images.push_back(resource);
+        image.slot = static_cast<uint32_t>(std::distance(m_slots.begin(), slot));
+    }
+
+    for(auto& slot : m_slots) {
+
+        slot.allocation = m_allocator->allocate(slot.requirements, vk::MemoryPropertyFlagBits::eDeviceLocal, ResourceKind::eOptimal, loader);
+
+        for(Resource resource : slot.images) {
+
+            Image& image = m_images[resource];
+            m_device.bindImageMemory(image.image, slot.allocation.memory, slot.allocation.offset, loader);
+
+            vk::ImageViewCreateInfo const imageViewCreateInfo
+            {
+                .sType = vk::StructureType::eImageViewCreateInfo,
+                .pNext = {},
+                .flags = {},
+                .image = image.image,
+                .viewType = vk::ImageViewType::e2D,
+                .format = image.description.format,
+                .components = {},
+                .subresourceRange = 
+                {
+                    .aspectMask = image.description.aspect,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1
+                }
+            };
+
+            vk::Result result = m_device.createImageView(&imageViewCreateInfo, nullptr, &image.imageView, loader);
+            if(result != vk::Result::eSuccess) {
+                throw std::runtime_error("Error: RenderGraph::createTransientImages()");
+            }
+        }
+    }
+}
+
+void RenderGraph::computeBarriers() {
+
+    struct State {
+        vk::ImageLayout             layout          {};
+        vk::PipelineStageFlags      writeStages     {};
+        vk::AccessFlags             writeAccess     {};
+        vk::PipelineStageFlags      readStages      {};
+        bool                        first           {};
+    };
+
+    struct FirstUse {
+        uint32_t                    position        {};
+        uint32_t                    barrier         {};
+        uint32_t                    slot            {};
+    };
+
+    std::vector<State> states(m_images.size());
+    for(Resource resource = 0; resource < m_images.size(); resource++) {
+        Image const& image = m_images[resource];
+        states[resource] = image.imported
+            ? State { .layout = image.initial.layout, .writeStages = image.initial.stages, .writeAccess = image.initial.access, .readStages = {}, .first = false }
+            : State { .layout = vk::ImageLayout::eUndefined, .writeStages = {}, .writeAccess = {}, .readStages = {}, .first = true };
+    }
+
+    std::vector<Resource> occupants(m_slots.size(), InvalidResource);
+    std::vector<FirstUse> firstUses;
+
+    m_batches.assign(m_order.size(), BarrierBatch {});
+
+    for(uint32_t position = 0; position < m_order.size(); position++) {
+
+        BarrierBatch& batch = m_batches[position];
+
+        for(auto const& use : m_passes[m_order[position]].uses) {
+
+            Image const& image = m_images[use.resource];
+            State& state = states[use.resource];
+
+            Barrier barrier
+            {
+                .resource = use.resource,
+                .srcAccess = {},
+                .dstAccess = use.access.access,
+                .oldLayout = state.layout,
+                .newLayout = use.access.layout
+            };
+
+            bool needed = false;
+            bool const transition = state.layout != use.access.layout;
+            vk::PipelineStageFlags srcStages {};
+
+            if(state.first) {
+                needed = true;
+                barrier.oldLayout = vk::ImageLayout::eUndefined;
+                Resource const previous = std::exchange(occupants[image.slot], use.resource);
+                if(previous == InvalidResource) {
+                    firstUses.push_back(FirstUse { .position = position, .barrier = static_cast<uint32_t>(batch.barriers.size()), .slot = image.slot });
+                } else {
+                    srcStages = states[previous].writeStages | states[previous].readStages;
+                    barrier.srcAccess = states[previous].writeAccess;
+                }
+                state.first = false;
+            } else if(transition || use.write) {
+                needed = true;
+                srcStages = state.writeStages | state.readStages;
+                barrier.srcAccess = state.writeAccess;
+            } else if(state.writeStages && (use.access.stages & ~state.readStages)) {
+                needed = true;
+                srcStages = state.writeStages;
+                barrier.srcAccess = state.writeAccess;
+            }
+
+            if(needed) {
+                batch.srcStages |= srcStages;
+                batch.dstStages |= use.access.stages;
+                batch.barriers.push_back(barrier);
+            }
+
+            if(use.write) {
+                state.writeStages = use.access.stages;
+                state.writeAccess = use.access.access;
+                state.readStages = {};
+            } else if(transition) {
+                state.readStages = use.access.stages;
+            } else {
+                state.readStages |= use.access.stages;
+            }
+            state.layout = use.access.layout;
+        }
+    }
+
+    for(auto const& firstUse : firstUses) {
+        State const& last = states[occupants[firstUse.slot]];
+        BarrierBatch& batch = m_batches[firstUse.position];
+        batch.srcStages |= last.writeStages | last.readStages;
+        batch.barriers[firstUse.barrier].srcAccess |= last.writeAccess;
+    }
+
+    m_finalBatch = BarrierBatch {};
+    for(Resource resource = 0; resource < m_images.size(); resource++) {
+
+        Image const& image = m_images[resource];
+        State const& state = states[resource];
+        if(!image.imported || (state.layout == image.final.layout && !(state.writeStages && image.final.stages))) {
+            continue;
+        }
+
+        m_finalBatch.srcStages |= state.writeStages | state.readStages;
+        m_finalBatch.dstStages |= image.final.stages;
+        m_finalBatch.barriers.push_back(Barrier
+        {
+            .resource = resource,
+            .srcAccess = state.writeAccess,
+            .dstAccess = image.final.access,
+            .oldLayout = state.layout,
+            .newLayout = image.final.layout
+        });
+    }
+
+    for(auto& batch : m_batches) {
+        if(!batch.srcStages) batch.srcStages = vk::PipelineStageFlagBits::eTopOfPipe;
+        if(!batch.dstStages) batch.dstStages = vk::PipelineStageFlagBits::eBottomOfPipe;
+    }
+    if(!m_finalBatch.srcStages) m_finalBatch.srcStages = vk::PipelineStageFlagBits::eTopOfPipe;
+    if(!m_finalBatch.dstStages) m_finalBatch.dstStages = vk::PipelineStageFlagBits::eBottomOfPipe;
+}
+
+void RenderGraph::compile(vk::Device device, Allocator& allocator, vk::DispatchLoaderDynamic const& loader) {
+
+    PROFILE_ZONE("RenderGraph::compile");
+
+    m_device = device;
+    m_allocator = &allocator;
+
+    destroyTransientImages(loader);
+
+    std::vector<bool> const live = cull();
+
+    m_order.clear();
+    for(uint32_t pass = 0; pass < m_passes.size(); pass++) {
+        if(live[pass]) m_order.push_back(pass);
+    }
+
+    for(uint32_t position = 0; position < m_order.size(); position++) {
+        for(auto const& use : m_passes[m_order[position]].uses) {
+            Image& image = m_images[use.resource];
+            image.firstUse = std::min(image.firstUse, position);
+            image.lastUse = std::max(image.lastUse, position);
+        }
+    }
+
+    createTransientImages(loader);
+    computeBarriers();
+}
+
+void RenderGraph::recordBarriers(vk::CommandBuffer commandBuffer, BarrierBatch const& batch, vk::DispatchLoaderDynamic const& loader) const {
+
+    if(batch.barriers.empty()) {
+        return;
+    }
+
+    std::vector<vk::ImageMemoryBarrier> imageMemoryBarriers;
+    imageMemoryBarriers.reserve(batch.barriers.size());
+
+    for(auto const& barrier : batch.barriers) {
+        Image const& image = m_images[barrier.resource];
+        imageMemoryBarriers.push_back(vk::ImageMemoryBarrier
+        {
+            .sType = vk::StructureType::eImageMemoryBarrier,
+            .pNext = {},
+            .srcAccessMask = barrier.srcAccess,
+            .dstAccessMask = barrier.dstAccess,
+            .oldLayout = barrier.oldLayout,
+            .newLayout = barrier.newLayout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image.image,
+            .subresourceRange = 
+            {
+                .aspectMask = image.description.aspect,
+                .baseMipLevel = 0,
+                .levelCount = VK_REMAINING_MIP_LEVELS,
+                .baseArrayLayer = 0,
+                .layerCount = VK_REMAINING_ARRAY_LAYERS
+            }
+        });
+    }
+
+    commandBuffer.pipelineBarrier(batch.srcStages, batch.dstStages, {}, 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageMemoryBarriers.size()), imageMemoryBarriers.data(), loader);
+}
+
+void RenderGraph::execute(vk::CommandBuffer commandBuffer, vk::DispatchLoaderDynamic const& loader, GpuProfiler* profiler) const {
+
+    PROFILE_ZONE("RenderGraph::execute");
+
+    for(uint32_t position = 0; position < m_order.size(); position++) {
+        recordBarriers(commandBuffer, m_batches[position], loader);
+
+        Pass const& pass = m_passes[m_order[position]];
+        if(!pass.execute) {
+            continue;
+        }
+
+        if(profiler) {
+            PROFILE_GPU_ZONE(*profiler, commandBuffer, pass.name, loader);
+            pass.execute(commandBuffer, *this);
+        } else {
+            pass.execute(commandBuffer, *this);
+        }
+    }
+
+    recordBarriers(commandBuffer, m_finalBatch, loader);
+}
+
+void RenderGraph::destroyTransientImages(vk::DispatchLoaderDynamic const& loader) {
+    retireTransientImages().destroy(m_device, *m_allocator, loader);
+}
+
+RenderGraph::RetiredImages RenderGraph::retireTransientImages() {
+
+    RetiredImages retired;
+
+    for(auto& image : m_images) {
+        if(!image.imported) {
+            if(image.imageView) retired.imageViews.push_back(image.imageView);
+            if(image.image) retired.images.push_back(image.image);
+            image.image = vk::Image {};
+            image.imageView = vk::ImageView {};
+        }
+        image.firstUse = UINT32_MAX;
+        image.lastUse = 0;
+        image.slot = UINT32_MAX;
+    }
+
+    for(auto& slot : m_slots) {
+        if(slot.allocation.memory) retired.allocations.push_back(slot.allocation);
+    }
+    m_slots.clear();
+
+    return retired;
+}
+
+void RenderGraph::RetiredImages::destroy(vk::Device device, Allocator& allocator, vk::DispatchLoaderDynamic const& loader) const {
+
+    for(auto imageView : imageViews) {
+        device.destroyImageView(imageView, nullptr, loader);
+    }
+
+    for(auto image : images) {
+        device.destroyImage(image, nullptr, loader);
+    }
+
+    for(auto const& allocation : allocations) {
+        allocator.free(allocation, loader);
+    }
+}
+
+void RenderGraph::reset(vk::DispatchLoaderDynamic const& loader) {
+
+    if(m_device) {
+        destroyTransientImages(loader);
+    }
+
+    m_passes.clear();
+    m_images.clear();
+    m_order.clear();
+    m_batches.clear();
+    m_finalBatch = BarrierBatch {};
+}
+
+void RenderGraph::destroy(vk::DispatchLoaderDynamic const& loader) {
+    reset(loader);
+    m_device = vk::Device {};
+}
+
+vk::Image RenderGraph::image(Resource resource) const {
+    return m_images.at(resource).image;
+}
+
+vk::ImageView RenderGraph::imageView(Resource resource) const {
+    return m_images.at(resource).imageView;
+}
+
+RenderGraph::ImageDescription const& RenderGraph::description(Resource resource) const {
+    return m_images.at(resource).description;
+}
+
+uint32_t RenderGraph::executedPassCount() const {
+    return static_cast<uint32_t>(m_order.size());
+}
+
+vk::DeviceSize RenderGraph::transientMemorySize() const {
+
+    vk::DeviceSize size = 0;
+    for(auto const& slot : m_slots) {
+        size += slot.requirements.size;
+    }
+    return size;
+}
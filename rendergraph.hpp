@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "allocator.hpp"
+#include "profiler.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+// Passes declare which images they read and write. compile() culls passes
+// that neither write an imported image nor are marked with sideEffect(),
+// precomputes one batched pipeline barrier per pass and places transient
+// images whose lifetimes don't overlap into the same memory. Passes run in
+// declaration order, which is always a valid topological order because a
+// pass can only depend on passes declared before it. Transient images
+// described with a zero extent follow the backbuffer extent; the owner
+// updates it with setBackbufferExtent() and recompiles after a resize.
+class RenderGraph final {
+
+    public:
+        using Resource = uint32_t;
+
+        static constexpr Resource InvalidResource = UINT32_MAX;
+
+        // Transients detached by retireTransientImages(). Frames in flight may
+        // still use them, so the owner destroys them once those have completed.
+        struct RetiredImages {
+            std::vector<vk::ImageView>  imageViews      {};
+            std::vector<vk::Image>      images          {};
+            std::vector<Allocation>     allocations     {};
+
+            void destroy(vk::Device device, Allocator& allocator, vk::DispatchLoaderDynamic const& loader) const;
+        };
+
+        struct ImageDescription {
+            vk::Format                  format          {};
+            vk::Extent2D                extent          {};
+            vk::ImageUsageFlags         usage           {};
+            vk::ImageAspectFlags        aspect          {vk::ImageAspectFlagBits::eColor};
+        };
+
+        struct Access {
+            vk::PipelineStageFlags      stages          {};
+            vk::AccessFlags             access          {};
+            vk::ImageLayout             layout          {};
+        };
+
+        class PassBuilder;
+
+        using Setup = std::function<void(PassBuilder& builder)>;
+        using Execute = std::function<void(vk::CommandBuffer commandBuffer, RenderGraph const& graph)>;
+
+    private:
+        struct Use {
+            Resource                    resource        {};
+            Access                      access          {};
+            bool                        write           {};
+        };
+
+        struct Pass {
+            std::string                 name            {};
+            std::vector<Use>            uses            {};
+            Execute                     execute         {};
+            bool                        sideEffect      {};
+        };
+
+        struct Image {
+            std::string                 name            {};
+            bool                        imported        {};
+            bool                        backbufferSized {};
+            ImageDescription            description     {};
+            vk::Image                   image           {};
+            vk::ImageView               imageView       {};
+            Access                      initial         {};
+            Access                      final           {};
+            uint32_t                    firstUse        {UINT32_MAX};
+            uint32_t                    lastUse         {};
+            uint32_t                    slot            {UINT32_MAX};
+        };
+
+        struct MemorySlot {
+            vk::MemoryRequirements      requirements    {};
+            Allocation                  allocation      {};
+            std::vector<Resource>       images          {};
+        };
+
+        struct Barrier {
+            Resource                    resource        {};
+            vk::AccessFlags             srcAccess       {};
+            vk::AccessFlags             dstAccess       {};
+            vk::ImageLayout             oldLayout       {};
+            vk::ImageLayout             newLayout       {};
+        };
+
+        struct BarrierBatch {
+            vk::PipelineStageFlags      srcStages       {};
+            vk::PipelineStageFlags      dstStages       {};
+            std::vector<Barrier>        barriers        {};
+        };
+
+    public:
+        class PassBuilder final {
+
+            private:
+                RenderGraph&            m_graph;
+                uint32_t                m_pass;
+
+            private:
+                friend class RenderGraph;
+                PassBuilder(RenderGraph& graph, uint32_t pass);
+
+                void use(Resource resource, Access const& access, bool write);
+
+            public:
+                void read(Resource resource, Access const& access);
+                void write(Resource resource, Access const& access);
+
+                void colorAttachment(Resource resource);
+                void depthAttachment(Resource resource);
+                void sampled(Resource resource, vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eFragmentShader);
+                void storageRead(Resource resource, vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eComputeShader);
+                void storageWrite(Resource resource, vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eComputeShader);
+                void transferSource(Resource resource);
+                void transferDestination(Resource resource);
+                void sideEffect();
+        };
+
+    private:
+        vk::Device                          m_device                    {};
+        Allocator*                          m_allocator                 {};
+        std::vector<Pass>                   m_passes                    {};
+        std::vector<Image>                  m_images                    {};
+        std::vector<MemorySlot>             m_slots                     {};
+        std::vector<uint32_t>               m_order                     {};
+        std::vector<BarrierBatch>           m_batches                   {};
+        BarrierBatch                        m_finalBatch                {};
+        vk::Extent2D                        m_backbufferExtent          {};
+
+    private:
+        std::vector<bool> cull() const;
+        void createTransientImages(vk::DispatchLoaderDynamic const& loader);
+        void computeBarriers();
+        void destroyTransientImages(vk::DispatchLoaderDynamic const& loader);
+        void recordBarriers(vk::CommandBuffer commandBuffer, BarrierBatch const& batch, vk::DispatchLoaderDynamic const& loader) const;
+
+    public:
+        Resource importImage(std::string name, vk::Image image, vk::ImageView imageView, Access const& initial, Access const& final, vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor);
+        void setImportedImage(Resource resource, vk::Image image, vk::ImageView imageView);
+        Resource createImage(std::string name, ImageDescription const& description);
+        void addPass(std::string name, Setup const& setup, Execute execute);
+        void setBackbufferExtent(vk::Extent2D extent);
+
+        void compile(vk::Device device, Allocator& allocator, vk::DispatchLoaderDynamic const& loader);
+        RetiredImages retireTransientImages();
+        void execute(vk::CommandBuffer commandBuffer, vk::DispatchLoaderDynamic const& loader, GpuProfiler* profiler = nullptr) const;
+        void reset(vk::DispatchLoaderDynamic const& loader);
+        void destroy(vk::DispatchLoaderDynamic const& loader);
+
+        vk::Image image(Resource resource) const;
+        vk::ImageView imageView(Resource resource) const;
+        ImageDescription const& description(Resource resource) const;
+
+        uint32_t executedPassCount() const;
+        vk::DeviceSize transientMemorySize() const;
+};
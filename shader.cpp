@@ -0,0 +1,58 @@
+#include "shader.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+std::vector<vk::DescriptorSetLayoutBinding> EmbeddedShader::setLayoutBindings(std::span<EmbeddedShader const* const> shaders, uint32_t set) {
+
+    std::vector<vk::DescriptorSetLayoutBinding> bindings;
+
+    for(EmbeddedShader const* shader : shaders) {
+        for(ShaderBinding const& reflected : shader->bindings) {
+            if(reflected.set != set) {
+                continue;
+            }
+
+            // Runtime arrays reflect with a count of zero; they are sized by
+            // whoever owns the set, so a single descriptor is assumed here.
+            uint32_t const count = std::max(reflected.count, 1u);
+
+            auto binding = std::ranges::find(bindings, reflected.binding, &vk::DescriptorSetLayoutBinding::binding);
+            if(binding == bindings.end()) {
+                bindings.push_back(vk::DescriptorSetLayoutBinding
+                {
+                    .binding = reflected.binding,
+                    .descriptorType = reflected.type,
+                    .descriptorCount = count,
+                    .stageFlags = shader->stage,
+                    .pImmutableSamplers = {}
+                });
+                continue;
+            }
+
+            if(binding->descriptorType != reflected.type || binding->descriptorCount != count) {
+                throw std::runtime_error("Error: EmbeddedShader::setLayoutBindings() stages disagree on a binding");
+            }
+            binding->stageFlags |= shader->stage;
+        }
+    }
+
+    std::ranges::sort(bindings, {}, &vk::DescriptorSetLayoutBinding::binding);
+    return bindings;
+}
+
+vk::PushConstantRange EmbeddedShader::pushConstantRange(std::span<EmbeddedShader const* const> shaders) {
+
+    vk::PushConstantRange range {};
+
+    for(EmbeddedShader const* shader : shaders) {
+        if(shader->pushConstantSize == 0) {
+            continue;
+        }
+
+        range.stageFlags |= shader->stage;
+        range.size = std::max(range.size, shader->pushConstantSize);
+    }
+
+    return range;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+struct ShaderBinding {
+    uint32_t                            set             {};
+    uint32_t                            binding         {};
+    vk::DescriptorType                  type            {};
+    uint32_t                            count           {1};
+};
+
+// SPIR-V compiled from shaders/ at build time and embedded by spirvembed
+// together with the resource interface reflected from it. Descriptor set
+// layouts and push constant ranges are derived from the reflection instead
+// of being written out by hand next to every pipeline.
+struct EmbeddedShader {
+    std::string_view                    name            {};
+    vk::ShaderStageFlagBits             stage           {};
+    std::span<uint32_t const>           code            {};
+    std::span<ShaderBinding const>      bindings        {};
+    uint32_t                            pushConstantSize {};
+    std::array<uint32_t, 3>             localSize       {};
+
+    static std::vector<vk::DescriptorSetLayoutBinding> setLayoutBindings(std::span<EmbeddedShader const* const> shaders, uint32_t set);
+    static vk::PushConstantRange pushConstantRange(std::span<EmbeddedShader const* const> shaders);
+};
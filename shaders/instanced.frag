@@ -0,0 +1,21 @@
+#version 460
+
+layout(location = 0) in vec3 inNormal;
+layout(location = 1) flat in uint inInstance;
+
+layout(location = 0) out vec4 outColor;
+
+vec3 palette(uint seed) {
+    seed = (seed ^ 61u) ^ (seed >> 16);
+    seed *= 9u;
+    seed ^= seed >> 4;
+    seed *= 0x27d4eb2du;
+    seed ^= seed >> 15;
+    return vec3(seed & 0xFFu, (seed >> 8) & 0xFFu, (seed >> 16) & 0xFFu) / 255.0;
+}
+
+void main() {
+
+    float diffuse = max(dot(normalize(inNormal), normalize(vec3(0.4, 0.8, 0.3))), 0.0);
+    outColor = vec4(palette(inInstance) * (0.2 + 0.8 * diffuse), 1.0);
+}
@@ -0,0 +1,30 @@
+#version 460
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+
+layout(set = 0, binding = 0, std430) readonly buffer Positions { vec4 positions[]; };
+layout(set = 0, binding = 1, std430) readonly buffer Orientations { vec4 orientations[]; };
+
+layout(push_constant) uniform Draw {
+    mat4 viewProjection;
+} draw;
+
+layout(location = 0) out vec3 outNormal;
+layout(location = 1) flat out uint outInstance;
+
+vec3 rotate(vec4 q, vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main() {
+
+    vec4 position = positions[gl_InstanceIndex];
+    vec4 orientation = orientations[gl_InstanceIndex];
+
+    vec3 world = rotate(orientation, inPosition * position.w) + position.xyz;
+
+    outNormal = rotate(orientation, inNormal);
+    outInstance = gl_InstanceIndex;
+    gl_Position = draw.viewProjection * vec4(world, 1.0);
+}
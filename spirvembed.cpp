@@ -0,0 +1,428 @@
+// Build-time tool: embeds compiled SPIR-V modules into a C++ header as
+// constexpr arrays and reflects their descriptor bindings, push constant
+// block size and workgroup size into EmbeddedShader records.
+//
+//     spirvembed <output.hpp> <name>=<module.spv>...
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // Subset of the SPIR-V grammar needed for resource reflection.
+    enum Op : uint32_t {
+        OpEntryPoint = 15,
+        OpExecutionMode = 16,
+        OpTypeInt = 21,
+        OpTypeFloat = 22,
+        OpTypeVector = 23,
+        OpTypeMatrix = 24,
+        OpTypeImage = 25,
+        OpTypeSampler = 26,
+        OpTypeSampledImage = 27,
+        OpTypeArray = 28,
+        OpTypeRuntimeArray = 29,
+        OpTypeStruct = 30,
+        OpTypePointer = 32,
+        OpConstant = 43,
+        OpVariable = 59,
+        OpDecorate = 71,
+        OpMemberDecorate = 72,
+        OpTypeAccelerationStructureKHR = 5341
+    };
+
+    enum Decoration : uint32_t {
+        DecorationBlock = 2,
+        DecorationBufferBlock = 3,
+        DecorationRowMajor = 4,
+        DecorationArrayStride = 6,
+        DecorationMatrixStride = 7,
+        DecorationBinding = 33,
+        DecorationDescriptorSet = 34,
+        DecorationOffset = 35
+    };
+
+    enum StorageClass : uint32_t {
+        StorageClassUniformConstant = 0,
+        StorageClassUniform = 2,
+        StorageClassPushConstant = 9,
+        StorageClassStorageBuffer = 12
+    };
+
+    constexpr uint32_t ExecutionModeLocalSize = 17;
+    constexpr uint32_t DimBuffer = 5;
+    constexpr uint32_t DimSubpassData = 6;
+
+    // VkDescriptorType and VkShaderStageFlagBits values, so the tool does not
+    // need the Vulkan headers on the host.
+    enum DescriptorType : uint32_t {
+        DescriptorTypeSampler = 0,
+        DescriptorTypeCombinedImageSampler = 1,
+        DescriptorTypeSampledImage = 2,
+        DescriptorTypeStorageImage = 3,
+        DescriptorTypeUniformTexelBuffer = 4,
+        DescriptorTypeStorageTexelBuffer = 5,
+        DescriptorTypeUniformBuffer = 6,
+        DescriptorTypeStorageBuffer = 7,
+        DescriptorTypeInputAttachment = 10,
+        DescriptorTypeAccelerationStructure = 1000150000
+    };
+
+    constexpr std::array<uint32_t, 6> ExecutionModelStages {
+        0x01,   // Vertex
+        0x02,   // TessellationControl
+        0x04,   // TessellationEvaluation
+        0x08,   // Geometry
+        0x10,   // Fragment
+        0x20    // GLCompute
+    };
+
+    struct Type {
+        uint32_t                        op              {};
+        std::vector<uint32_t>           operands        {};
+    };
+
+    struct Binding {
+        uint32_t                        set             {};
+        uint32_t                        binding         {};
+        uint32_t                        type            {};
+        uint32_t                        count           {1};
+    };
+
+    struct Reflection {
+        uint32_t                        stage           {};
+        std::vector<Binding>            bindings        {};
+        uint32_t                        pushConstantSize {};
+        std::array<uint32_t, 3>         localSize       {};
+    };
+
+    class Module final {
+
+        private:
+            std::vector<uint32_t> const&                    m_code;
+            std::map<uint32_t, Type>                        m_types             {};
+            std::map<uint32_t, uint32_t>                    m_constants         {};
+            std::map<uint32_t, std::map<uint32_t, uint32_t>> m_decorations      {};
+            std::map<std::pair<uint32_t, uint32_t>, std::map<uint32_t, uint32_t>> m_memberDecorations {};
+            std::vector<std::pair<uint32_t, uint32_t>>      m_variables         {};
+            uint32_t                                        m_entryPoint        {};
+            Reflection                                      m_reflection        {};
+
+        private:
+            std::optional<uint32_t> decoration(uint32_t id, uint32_t decoration) const {
+                auto const decorations = m_decorations.find(id);
+                if(decorations == m_decorations.end()) return std::nullopt;
+                auto const value = decorations->second.find(decoration);
+                if(value == decorations->second.end()) return std::nullopt;
+                return value->second;
+            }
+
+            std::optional<uint32_t> memberDecoration(uint32_t id, uint32_t member, uint32_t decoration) const {
+                auto const decorations = m_memberDecorations.find({id, member});
+                if(decorations == m_memberDecorations.end()) return std::nullopt;
+                auto const value = decorations->second.find(decoration);
+                if(value == decorations->second.end()) return std::nullopt;
+                return value->second;
+            }
+
+            Type const& type(uint32_t id) const {
+                auto const type = m_types.find(id);
+                if(type == m_types.end()) {
+                    throw std::runtime_error("Error: spirvembed unknown type %" + std::to_string(id));
+                }
+                return type->second;
+            }
+
+            // MatrixStride and RowMajor decorate the struct member that holds
+            // the matrix, so they are passed down through any arrays to it.
+            uint32_t size(uint32_t id, std::optional<uint32_t> matrixStride = std::nullopt, bool rowMajor = false) const {
+
+                Type const& t = type(id);
+                switch(t.op) {
+                    case OpTypeInt:
+                    case OpTypeFloat:
+                        return t.operands[0] / 8;
+                    case OpTypeVector:
+                        return size(t.operands[0]) * t.operands[1];
+                    case OpTypeMatrix:
+                        if(matrixStride) return *matrixStride * (rowMajor ? type(t.operands[0]).operands[1] : t.operands[1]);
+                        return size(t.operands[0]) * t.operands[1];
+                    case OpTypeArray:
+                        return decoration(id, DecorationArrayStride).value_or(size(t.operands[0], matrixStride, rowMajor)) * m_constants.at(t.operands[1]);
+                    case OpTypeRuntimeArray:
+                        return 0;
+                    case OpTypeStruct: {
+                        uint32_t end = 0;
+                        for(uint32_t member = 0; member < t.operands.size(); member++) {
+                            uint32_t const offset = memberDecoration(id, member, DecorationOffset).value_or(end);
+                            bool const memberRowMajor = memberDecoration(id, member, DecorationRowMajor).has_value();
+                            end = std::max(end, offset + size(t.operands[member], memberDecoration(id, member, DecorationMatrixStride), memberRowMajor));
+                        }
+                        return end;
+                    }
+                    default:
+                        throw std::runtime_error("Error: spirvembed cannot size type %" + std::to_string(id));
+                }
+            }
+
+            uint32_t descriptorType(uint32_t id, uint32_t storageClass) const {
+
+                Type const& t = type(id);
+                switch(t.op) {
+                    case OpTypeSampler:
+                        return DescriptorTypeSampler;
+                    case OpTypeSampledImage:
+                        return type(t.operands[0]).operands[1] == DimBuffer ? DescriptorTypeUniformTexelBuffer : DescriptorTypeCombinedImageSampler;
+                    case OpTypeImage:
+                        if(t.operands[1] == DimSubpassData) return DescriptorTypeInputAttachment;
+                        if(t.operands[1] == DimBuffer) return t.operands[5] == 2 ? DescriptorTypeStorageTexelBuffer : DescriptorTypeUniformTexelBuffer;
+                        return t.operands[5] == 2 ? DescriptorTypeStorageImage : DescriptorTypeSampledImage;
+                    case OpTypeAccelerationStructureKHR:
+                        return DescriptorTypeAccelerationStructure;
+                    case OpTypeStruct:
+                        if(storageClass == StorageClassStorageBuffer || decoration(id, DecorationBufferBlock)) return DescriptorTypeStorageBuffer;
+                        return DescriptorTypeUniformBuffer;
+                    default:
+                        throw std::runtime_error("Error: spirvembed unsupported resource type %" + std::to_string(id));
+                }
+            }
+
+            void parse() {
+
+                if(m_code.size() < 5 || m_code[0] != 0x07230203) {
+                    throw std::runtime_error("Error: spirvembed not a SPIR-V module");
+                }
+
+                for(size_t word = 5; word < m_code.size();) {
+
+                    uint32_t const op = m_code[word] & 0xFFFF;
+                    uint32_t const count = m_code[word] >> 16;
+                    if(count == 0 || word + count > m_code.size()) {
+                        throw std::runtime_error("Error: spirvembed truncated instruction");
+                    }
+                    uint32_t const* operands = &m_code[word + 1];
+
+                    switch(op) {
+                        case OpEntryPoint:
+                            if(m_entryPoint == 0) {
+                                m_entryPoint = operands[1];
+                                m_reflection.stage = operands[0] < ExecutionModelStages.size() ? ExecutionModelStages[operands[0]] : 0;
+                            }
+                            break;
+                        case OpExecutionMode:
+                            if(operands[1] == ExecutionModeLocalSize) {
+                                m_reflection.localSize = { operands[2], operands[3], operands[4] };
+                            }
+                            break;
+                        case OpTypeInt:
+                        case OpTypeFloat:
+                        case OpTypeVector:
+                        case OpTypeMatrix:
+                        case OpTypeImage:
+                        case OpTypeSampler:
+                        case OpTypeSampledImage:
+                        case OpTypeArray:
+                        case OpTypeRuntimeArray:
+                        case OpTypeStruct:
+                        case OpTypePointer:
+                        case OpTypeAccelerationStructureKHR:
+                            m_types[operands[0]] = Type { .op = op, .operands = std::vector<uint32_t>(operands + 1, operands + count - 1) };
+                            break;
+                        case OpConstant:
+                            m_constants[operands[1]] = operands[2];
+                            break;
+                        case OpVariable:
+                            m_variables.emplace_back(operands[1], operands[0]);
+                            break;
+                        case OpDecorate:
+                            m_decorations[operands[0]][operands[1]] = count > 3 ? operands[2] : 1;
+                            break;
+                        case OpMemberDecorate:
+                            m_memberDecorations[{operands[0], operands[1]}][operands[2]] = count > 4 ? operands[3] : 1;
+                            break;
+                    }
+
+                    word += count;
+                }
+            }
+
+            void reflect() {
+
+                for(auto const& [variable, pointerType] : m_variables) {
+
+                    Type const& pointer = type(pointerType);
+                    uint32_t const storageClass = pointer.operands[0];
+                    uint32_t pointee = pointer.operands[1];
+
+                    if(storageClass == StorageClassPushConstant) {
+                        m_reflection.pushConstantSize = std::max(m_reflection.pushConstantSize, size(pointee));
+                        continue;
+                    }
+
+                    if(storageClass != StorageClassUniformConstant && storageClass != StorageClassUniform && storageClass != StorageClassStorageBuffer) {
+                        continue;
+                    }
+
+                    Binding binding
+                    {
+                        .set = decoration(variable, DecorationDescriptorSet).value_or(0),
+                        .binding = decoration(variable, DecorationBinding).value_or(0),
+                        .type = 0,
+                        .count = 1
+                    };
+
+                    Type const* resource = &type(pointee);
+                    if(resource->op == OpTypeArray) {
+                        binding.count = m_constants.at(resource->operands[1]);
+                        pointee = resource->operands[0];
+                    } else if(resource->op == OpTypeRuntimeArray) {
+                        binding.count = 0;
+                        pointee = resource->operands[0];
+                    }
+
+                    binding.type = descriptorType(pointee, storageClass);
+                    m_reflection.bindings.push_back(binding);
+                }
+
+                std::ranges::sort(m_reflection.bindings, [](Binding const& a, Binding const& b) {
+                    return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+                });
+            }
+
+        public:
+            explicit Module(std::vector<uint32_t> const& code) : m_code(code) {
+                parse();
+                reflect();
+            }
+
+            Reflection const& reflection() const {
+                return m_reflection;
+            }
+    };
+
+    std::vector<uint32_t> readModule(std::filesystem::path const& path) {
+
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file) {
+            throw std::runtime_error("Error: spirvembed cannot open " + path.string());
+        }
+
+        auto const bytes = static_cast<size_t>(file.tellg());
+        if(bytes % sizeof(uint32_t) != 0) {
+            throw std::runtime_error("Error: spirvembed " + path.string() + " is not word aligned");
+        }
+
+        std::vector<uint32_t> code(bytes / sizeof(uint32_t));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(code.data()), static_cast<std::streamsize>(bytes));
+        return code;
+    }
+
+    // cull.comp -> cullComp
+    std::string identifier(std::string const& name) {
+
+        std::string result;
+        bool upper = false;
+        for(char c : name) {
+            if(std::isalnum(static_cast<unsigned char>(c))) {
+                result += upper ? static_cast<char>(std::toupper(static_cast<unsigned char>(c))) : c;
+                upper = false;
+            } else {
+                upper = !result.empty();
+            }
+        }
+
+        if(result.empty() || std::isdigit(static_cast<unsigned char>(result.front()))) {
+            result.insert(0, "shader");
+        }
+        return result;
+    }
+
+    void writeShader(std::ostream& out, std::string const& name, std::vector<uint32_t> const& code, Reflection const& reflection) {
+
+        std::string const id = identifier(name);
+
+        out << "    inline constexpr uint32_t " << id << "Code[] {" << std::hex << std::setfill('0');
+        for(size_t word = 0; word < code.size(); word++) {
+            out << (word % 8 == 0 ? "\n        " : " ") << "0x" << std::setw(8) << code[word] << ",";
+        }
+        out << std::dec << std::setfill(' ') << "\n    };\n\n";
+
+        if(!reflection.bindings.empty()) {
+            out << "    inline constexpr ShaderBinding " << id << "Bindings[] {\n";
+            for(Binding const& binding : reflection.bindings) {
+                out << "        ShaderBinding { .set = " << binding.set
+                    << ", .binding = " << binding.binding
+                    << ", .type = static_cast<vk::DescriptorType>(" << binding.type << ")"
+                    << ", .count = " << binding.count << " },\n";
+            }
+            out << "    };\n\n";
+        }
+
+        out << "    inline constexpr EmbeddedShader " << id << " {\n";
+        out << "        .name = \"" << name << "\",\n";
+        out << "        .stage = static_cast<vk::ShaderStageFlagBits>(" << reflection.stage << "),\n";
+        out << "        .code = " << id << "Code,\n";
+        out << "        .bindings = " << (reflection.bindings.empty() ? std::string("{}") : id + "Bindings") << ",\n";
+        out << "        .pushConstantSize = " << reflection.pushConstantSize << ",\n";
+        out << "        .localSize = { " << reflection.localSize[0] << ", " << reflection.localSize[1] << ", " << reflection.localSize[2] << " }\n";
+        out << "    };\n\n";
+    }
+}
+
+int main(int argc, char** argv) {
+
+    if(argc < 3) {
+        std::cerr << "usage: spirvembed <output.hpp> <name>=<module.spv>..." << std::endl;
+        return 1;
+    }
+
+    try {
+        std::filesystem::path const output = argv[1];
+        std::filesystem::path const temporary = std::filesystem::path(output).concat(".tmp");
+
+        {
+            std::ofstream out(temporary, std::ios::trunc);
+            out << "#pragma once\n\n";
+            out << "// Generated by spirvembed. Do not edit.\n\n";
+            out << "#include \"shader.hpp\"\n\n";
+            out << "namespace shaders {\n\n";
+
+            for(int argument = 2; argument < argc; argument++) {
+
+                std::string const entry = argv[argument];
+                size_t const separator = entry.find('=');
+                if(separator == std::string::npos) {
+                    throw std::runtime_error("Error: spirvembed expected <name>=<module.spv>, got " + entry);
+                }
+
+                std::string const name = entry.substr(0, separator);
+                std::vector<uint32_t> const code = readModule(entry.substr(separator + 1));
+                writeShader(out, name, code, Module(code).reflection());
+            }
+
+            out << "}\n";
+            if(!out) {
+                throw std::runtime_error("Error: spirvembed cannot write " + temporary.string());
+            }
+        }
+
+        std::filesystem::rename(temporary, output);
+    } catch(std::exception const& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// Head and tail only ever grow; the slot is the counter masked by Capacity.
+template<typename T, std::size_t Capacity>
+class SpscQueue final {
+
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    private:
+        static constexpr std::size_t CacheLine = 64;
+
+    private:
+        alignas(CacheLine) std::atomic<std::size_t>     m_head          {};
+        alignas(CacheLine) std::atomic<std::size_t>     m_tail          {};
+        alignas(CacheLine) std::array<T, Capacity>      m_items         {};
+
+    public:
+        bool tryPush(T const& item) {
+
+            std::size_t const tail = m_tail.load(std::memory_order_relaxed);
+            if(tail - m_head.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+
+            m_items[tail & (Capacity - 1)] = item;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool tryPop(T& item) {
+
+            std::size_t const head = m_head.load(std::memory_order_relaxed);
+            if(head == m_tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            item = std::move(m_items[head & (Capacity - 1)]);
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+        }
+};
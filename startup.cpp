@@ -0,0 +1,121 @@
+#include "startup.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace {
+    constexpr uint32_t DeviceSelectionMagic = 0x53444541;
+    constexpr uint32_t DeviceSelectionVersion = 2;
+}
+
+void StartupReport::record(char const* name, uint64_t begin, uint64_t end) {
+
+    std::lock_guard lock(m_mutex);
+    m_stages.push_back(Stage { .name = name, .begin = begin, .end = end, .worker = std::this_thread::get_id() != m_mainThread });
+}
+
+double StartupReport::total() const {
+
+    std::lock_guard lock(m_mutex);
+
+    uint64_t end = m_origin;
+    for(auto const& stage : m_stages) {
+        end = std::max(end, stage.end);
+    }
+    return static_cast<double>(end - m_origin) / 1e6;
+}
+
+void StartupReport::print(std::ostream& stream) const {
+
+    std::vector<Stage> stages;
+    {
+        std::lock_guard lock(m_mutex);
+        stages = m_stages;
+    }
+    std::ranges::sort(stages, {}, &Stage::begin);
+
+    stream << std::fixed << std::setprecision(3);
+    stream << std::left << std::setw(24) << "startup stage" << std::right << std::setw(12) << "start ms" << std::setw(12) << "time ms" << "  thread" << std::endl;
+    for(auto const& stage : stages) {
+        stream << std::left << std::setw(24) << stage.name << std::right
+               << std::setw(12) << static_cast<double>(stage.begin - m_origin) / 1e6
+               << std::setw(12) << static_cast<double>(stage.end - stage.begin) / 1e6
+               << "  " << (stage.worker ? "worker" : "main") << std::endl;
+    }
+    stream << std::left << std::setw(24) << "total" << std::right << std::setw(24) << total() << std::endl;
+    stream << std::defaultfloat;
+}
+
+DeviceSelection DeviceSelection::identify(vk::PhysicalDevice physicalDevice, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::PhysicalDeviceIDProperties idProperties { .sType = vk::StructureType::ePhysicalDeviceIdProperties };
+
+    vk::PhysicalDeviceProperties2 properties
+    {
+        .sType = vk::StructureType::ePhysicalDeviceProperties2,
+        .pNext = &idProperties,
+        .properties = {}
+    };
+    physicalDevice.getProperties2(&properties, loader);
+
+    DeviceSelection selection;
+    std::memcpy(selection.deviceUUID.data(), idProperties.deviceUUID.data(), selection.deviceUUID.size());
+    selection.driverVersion = properties.properties.driverVersion;
+    return selection;
+}
+
+std::optional<DeviceSelection> DeviceSelection::load(std::filesystem::path const& path) {
+
+    std::ifstream file(path, std::ios::binary);
+    if(!file) {
+        return std::nullopt;
+    }
+
+    uint32_t magic {};
+    uint32_t version {};
+    DeviceSelection selection;
+
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(selection.deviceUUID.data()), static_cast<std::streamsize>(selection.deviceUUID.size()));
+    file.read(reinterpret_cast<char*>(&selection.driverVersion), sizeof(selection.driverVersion));
+    file.read(reinterpret_cast<char*>(&selection.graphicsQueueFamilyIndex), sizeof(selection.graphicsQueueFamilyIndex));
+    file.read(reinterpret_cast<char*>(&selection.transferQueueFamilyIndex), sizeof(selection.transferQueueFamilyIndex));
+    file.read(reinterpret_cast<char*>(&selection.computeQueueFamilyIndex), sizeof(selection.computeQueueFamilyIndex));
+
+    if(!file || magic != DeviceSelectionMagic || version != DeviceSelectionVersion) {
+        return std::nullopt;
+    }
+    return selection;
+}
+
+void DeviceSelection::save(std::filesystem::path const& path) const {
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    auto temporary = path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<char const*>(&DeviceSelectionMagic), sizeof(DeviceSelectionMagic));
+        file.write(reinterpret_cast<char const*>(&DeviceSelectionVersion), sizeof(DeviceSelectionVersion));
+        file.write(reinterpret_cast<char const*>(deviceUUID.data()), static_cast<std::streamsize>(deviceUUID.size()));
+        file.write(reinterpret_cast<char const*>(&driverVersion), sizeof(driverVersion));
+        file.write(reinterpret_cast<char const*>(&graphicsQueueFamilyIndex), sizeof(graphicsQueueFamilyIndex));
+        file.write(reinterpret_cast<char const*>(&transferQueueFamilyIndex), sizeof(transferQueueFamilyIndex));
+        file.write(reinterpret_cast<char const*>(&computeQueueFamilyIndex), sizeof(computeQueueFamilyIndex));
+        if(!file) {
+            return;
+        }
+    }
+
+    std::filesystem::rename(temporary, path, error);
+}
+
+bool DeviceSelection::matches(DeviceSelection const& other) const {
+    return deviceUUID == other.deviceUUID && driverVersion == other.driverVersion;
+}
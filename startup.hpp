@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frametimer.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+// Wall clock time of every init step run by the Window factories. Steps may
+// run on the startup worker, so recording is guarded by a mutex.
+class StartupReport final {
+
+    private:
+        struct Stage {
+            std::string                 name            {};
+            uint64_t                    begin           {};
+            uint64_t                    end             {};
+            bool                        worker          {};
+        };
+
+    private:
+        uint64_t                        m_origin                    {FrameTimer::now()};
+        std::thread::id                 m_mainThread                {std::this_thread::get_id()};
+        std::vector<Stage>              m_stages                    {};
+        mutable std::mutex              m_mutex                     {};
+
+    public:
+        template<typename Function>
+        void measure(char const* name, Function&& function) {
+            uint64_t const begin = FrameTimer::now();
+            function();
+            record(name, begin, FrameTimer::now());
+        }
+
+        void record(char const* name, uint64_t begin, uint64_t end);
+        double total() const;
+        void print(std::ostream& stream) const;
+};
+
+// Physical device and queue families picked on a previous run. The entry is
+// only reused while the device UUID and driver version still match.
+struct DeviceSelection {
+    std::array<uint8_t, VK_UUID_SIZE>   deviceUUID                  {};
+    uint32_t                            driverVersion               {};
+    uint32_t                            graphicsQueueFamilyIndex    {};
+    uint32_t                            transferQueueFamilyIndex    {};
+    uint32_t                            computeQueueFamilyIndex     {};
+
+    static DeviceSelection identify(vk::PhysicalDevice physicalDevice, vk::DispatchLoaderDynamic const& loader);
+    static std::optional<DeviceSelection> load(std::filesystem::path const& path);
+    void save(std::filesystem::path const& path) const;
+
+    bool matches(DeviceSelection const& other) const;
+};
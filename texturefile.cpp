@@ -0,0 +1,293 @@
+#include "texturefile.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    vk::Extent3D levelExtent(TextureFileHeader const& header, uint32_t level) {
+        return vk::Extent3D
+        {
+            .width = std::max(header.width >> level, 1u),
+            .height = std::max(header.height >> level, 1u),
+            .depth = std::max(header.depth >> level, 1u)
+        };
+    }
+}
+
+MappedFile::MappedFile(MappedFile&& file) noexcept
+    : m_data(std::exchange(file.m_data, nullptr)), m_size(std::exchange(file.m_size, 0)) {}
+
+MappedFile& MappedFile::operator = (MappedFile&& file) noexcept {
+
+    if(this != &file) {
+        close();
+        m_data = std::exchange(file.m_data, nullptr);
+        m_size = std::exchange(file.m_size, 0);
+    }
+    return *this;
+}
+
+void MappedFile::open(std::filesystem::path const& path) {
+
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Error: MappedFile::open()");
+    }
+
+    LARGE_INTEGER size {};
+    GetFileSizeEx(file, &size);
+
+    HANDLE mapping = size.QuadPart > 0 ? CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr) : nullptr;
+    CloseHandle(file);
+    if(mapping == nullptr) {
+        throw std::runtime_error("Error: MappedFile::open()");
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mapping);
+    if(data == nullptr) {
+        throw std::runtime_error("Error: MappedFile::open()");
+    }
+
+    m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+    int const file = ::open(path.c_str(), O_RDONLY);
+    if(file < 0) {
+        throw std::runtime_error("Error: MappedFile::open()");
+    }
+
+    struct stat status {};
+    if(fstat(file, &status) != 0 || status.st_size <= 0) {
+        ::close(file);
+        throw std::runtime_error("Error: MappedFile::open()");
+    }
+
+    void* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if(data == MAP_FAILED) {
+        throw std::runtime_error("Error: MappedFile::open()");
+    }
+
+    // Levels are read front to back once; let the kernel read ahead and drop
+    // pages behind the copy.
+    madvise(data, static_cast<std::size_t>(status.st_size), MADV_SEQUENTIAL);
+
+    m_size = static_cast<std::size_t>(status.st_size);
+#endif
+
+    m_data = static_cast<std::byte*>(data);
+}
+
+void MappedFile::close() {
+
+    if(!m_data) {
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(m_data);
+#else
+    munmap(m_data, m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+std::span<std::byte const> MappedFile::bytes() const {
+    return std::span<std::byte const>(m_data, m_size);
+}
+
+std::byte* MappedFile::data() const {
+    return m_data;
+}
+
+std::size_t MappedFile::size() const {
+    return m_size;
+}
+
+vk::DeviceSize TextureFile::levelSize(vk::Format format, vk::Extent3D const& extent, uint32_t layers) {
+
+    uint8_t const blockSize = vk::blockSize(format);
+    if(blockSize == 0) {
+        throw std::runtime_error("Error: TextureFile::levelSize() unsupported format");
+    }
+
+    auto const blockExtent = vk::blockExtent(format);
+    vk::DeviceSize const columns = (extent.width + blockExtent[0] - 1) / blockExtent[0];
+    vk::DeviceSize const rows = (extent.height + blockExtent[1] - 1) / blockExtent[1];
+    vk::DeviceSize const slices = (extent.depth + blockExtent[2] - 1) / blockExtent[2];
+
+    return columns * rows * slices * blockSize * layers;
+}
+
+void TextureFile::write(std::filesystem::path const& path, vk::Format format, vk::Extent3D const& extent, uint32_t layers, std::span<std::span<std::byte const> const> levels) {
+
+    if(levels.empty() || levels.size() > MaxLevels || levels.size() > static_cast<std::size_t>(std::bit_width(std::max({extent.width, extent.height, extent.depth})))) {
+        throw std::runtime_error("Error: TextureFile::write() invalid level count");
+    }
+
+    if(extent.depth > 1 && layers > 1) {
+        throw std::runtime_error("Error: TextureFile::write() 3D textures cannot have layers");
+    }
+
+    auto const align = [](uint64_t value) {
+        return (value + Alignment - 1) / Alignment * Alignment;
+    };
+
+    TextureFileHeader const header
+    {
+        .magic = Magic,
+        .version = Version,
+        .format = static_cast<uint32_t>(format),
+        .width = extent.width,
+        .height = extent.height,
+        .depth = extent.depth,
+        .layers = layers,
+        .levels = static_cast<uint32_t>(levels.size()),
+        .alignment = Alignment
+    };
+
+    std::vector<TextureFileLevel> table(levels.size());
+    uint64_t offset = align(sizeof(TextureFileHeader) + sizeof(TextureFileLevel) * table.size());
+
+    for(uint32_t x=0; x<table.size(); x++) {
+        if(levels[x].size() != levelSize(format, levelExtent(header, x), layers)) {
+            throw std::runtime_error("Error: TextureFile::write() level size does not match its extent");
+        }
+
+        table[x] = TextureFileLevel { .offset = offset, .size = levels[x].size() };
+        offset = align(offset + levels[x].size());
+    }
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if(!stream) {
+        throw std::runtime_error("Error: TextureFile::write()");
+    }
+
+    std::vector<char> const padding(Alignment);
+    auto const pad = [&stream, &padding, &align]() {
+        uint64_t const position = static_cast<uint64_t>(stream.tellp());
+        stream.write(padding.data(), static_cast<std::streamsize>(align(position) - position));
+    };
+
+    stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<char const*>(table.data()), static_cast<std::streamsize>(sizeof(TextureFileLevel) * table.size()));
+    pad();
+
+    for(auto const& level : levels) {
+        stream.write(reinterpret_cast<char const*>(level.data()), static_cast<std::streamsize>(level.size()));
+        pad();
+    }
+
+    if(!stream) {
+        throw std::runtime_error("Error: TextureFile::write()");
+    }
+}
+
+void TextureFile::open(std::filesystem::path const& path) {
+
+    m_file.open(path);
+
+    auto const bytes = m_file.bytes();
+    auto const fail = [this](char const* message) {
+        close();
+        throw std::runtime_error(message);
+    };
+
+    if(bytes.size() < sizeof(TextureFileHeader)) {
+        fail("Error: TextureFile::open() truncated header");
+    }
+
+    m_header = reinterpret_cast<TextureFileHeader const*>(bytes.data());
+    if(m_header->magic != Magic || m_header->version != Version) {
+        fail("Error: TextureFile::open() not a texture file");
+    }
+
+    if(m_header->levels == 0 || m_header->levels > MaxLevels || m_header->layers == 0 || m_header->width == 0 || m_header->height == 0 || m_header->depth == 0) {
+        fail("Error: TextureFile::open() invalid header");
+    }
+
+    // A full chain ends at 1x1x1 after floor(log2(largest dimension)) halvings.
+    if(m_header->levels > static_cast<uint32_t>(std::bit_width(std::max({m_header->width, m_header->height, m_header->depth})))) {
+        fail("Error: TextureFile::open() more levels than a full mip chain");
+    }
+
+    if(m_header->depth > 1 && m_header->layers > 1) {
+        fail("Error: TextureFile::open() 3D textures cannot have layers");
+    }
+
+    if(m_header->alignment < 16 || !std::has_single_bit(m_header->alignment)) {
+        fail("Error: TextureFile::open() invalid alignment");
+    }
+
+    std::size_t const tableEnd = sizeof(TextureFileHeader) + sizeof(TextureFileLevel) * m_header->levels;
+    if(bytes.size() < tableEnd) {
+        fail("Error: TextureFile::open() truncated level table");
+    }
+
+    m_levels = std::span(reinterpret_cast<TextureFileLevel const*>(bytes.data() + sizeof(TextureFileHeader)), m_header->levels);
+
+    for(uint32_t x=0; x<m_header->levels; x++) {
+        TextureFileLevel const& level = m_levels[x];
+        if(level.offset % m_header->alignment != 0 || level.offset < tableEnd || level.offset > bytes.size() || level.size > bytes.size() - level.offset) {
+            fail("Error: TextureFile::open() level out of bounds");
+        }
+
+        if(level.size != levelSize(format(), extent(x), m_header->layers)) {
+            fail("Error: TextureFile::open() level size does not match its extent");
+        }
+    }
+}
+
+void TextureFile::close() {
+    m_file.close();
+    m_header = nullptr;
+    m_levels = {};
+}
+
+vk::Format TextureFile::format() const {
+    return static_cast<vk::Format>(m_header->format);
+}
+
+vk::Extent3D TextureFile::extent(uint32_t level) const {
+    return levelExtent(*m_header, level);
+}
+
+uint32_t TextureFile::layers() const {
+    return m_header->layers;
+}
+
+uint32_t TextureFile::levels() const {
+    return m_header->levels;
+}
+
+vk::DeviceSize TextureFile::offset(uint32_t level) const {
+    return m_levels[level].offset;
+}
+
+std::span<std::byte const> TextureFile::level(uint32_t level) const {
+    return m_file.bytes().subspan(m_levels[level].offset, m_levels[level].size);
+}
+
+MappedFile const& TextureFile::mapping() const {
+    return m_file;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+static_assert(std::endian::native == std::endian::little, "texture files are little endian");
+
+// A whole file mapped through the page cache. The mapping is private and
+// writable so drivers can import it as host memory; nothing writes to it.
+class MappedFile final {
+
+    private:
+        std::byte*                      m_data                      {};
+        std::size_t                     m_size                      {};
+
+    public:
+        MappedFile() = default;
+        MappedFile(MappedFile const&) = delete;
+        MappedFile(MappedFile&& file) noexcept;
+
+        MappedFile& operator = (MappedFile const&) = delete;
+        MappedFile& operator = (MappedFile&& file) noexcept;
+
+        ~MappedFile() {
+            close();
+        }
+
+    public:
+        void open(std::filesystem::path const& path);
+        void close();
+
+        std::span<std::byte const> bytes() const;
+        std::byte* data() const;
+        std::size_t size() const;
+};
+
+// On-disk layout of a texture file. The level table follows the header. Each
+// level holds all layers tightly packed in the order vkCmdCopyBufferToImage
+// reads them, starts at a multiple of `alignment`, and the file is padded to
+// one too. A mapping of the file can therefore be copied from, or imported
+// as a buffer, without any parsing.
+struct TextureFileHeader {
+    std::array<char, 8>                 magic           {};
+    uint32_t                            version         {};
+    uint32_t                            format          {};
+    uint32_t                            width           {};
+    uint32_t                            height          {};
+    uint32_t                            depth           {};
+    uint32_t                            layers          {};
+    uint32_t                            levels          {};
+    uint32_t                            alignment       {};
+};
+
+struct TextureFileLevel {
+    uint64_t                            offset          {};
+    uint64_t                            size            {};
+};
+
+static_assert(sizeof(TextureFileHeader) == 40 && sizeof(TextureFileLevel) == 16);
+
+// A validated, mapped texture file. Levels point straight into the mapping.
+class TextureFile final {
+
+    public:
+        static constexpr std::array<char, 8> Magic { '\xAB', 'A', 'T', 'X', '\r', '\n', '\x1A', '\n' };
+        static constexpr uint32_t Version = 1;
+        static constexpr uint32_t Alignment = 4096;
+        static constexpr uint32_t MaxLevels = 16;
+
+    private:
+        MappedFile                          m_file                  {};
+        TextureFileHeader const*            m_header                {};
+        std::span<TextureFileLevel const>   m_levels                {};
+
+    public:
+        static vk::DeviceSize levelSize(vk::Format format, vk::Extent3D const& extent, uint32_t layers);
+        static void write(std::filesystem::path const& path, vk::Format format, vk::Extent3D const& extent, uint32_t layers, std::span<std::span<std::byte const> const> levels);
+
+    public:
+        void open(std::filesystem::path const& path);
+        void close();
+
+        vk::Format format() const;
+        vk::Extent3D extent(uint32_t level = 0) const;
+        uint32_t layers() const;
+        uint32_t levels() const;
+        vk::DeviceSize offset(uint32_t level) const;
+        std::span<std::byte const> level(uint32_t level) const;
+        MappedFile const& mapping() const;
+};
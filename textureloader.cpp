@@ -0,0 +1,237 @@
+#include "textureloader.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+void TextureLoader::create(vk::Device device, vk::PhysicalDevice physicalDevice, Allocator& allocator, Uploader& uploader, vk::DeviceSize hostPointerAlignment) {
+    m_device = device;
+    m_physicalDevice = physicalDevice;
+    m_allocator = &allocator;
+    m_uploader = &uploader;
+    m_hostPointerAlignment = hostPointerAlignment;
+}
+
+void TextureLoader::destroy(vk::DispatchLoaderDynamic const& loader) {
+
+    for(Import& import : m_imports) {
+        m_device.destroyBuffer(import.buffer, nullptr, loader);
+        m_device.freeMemory(import.memory, nullptr, loader);
+    }
+
+    m_imports.clear();
+}
+
+bool TextureLoader::importHost(Texture& texture, TextureFile& file, vk::DispatchLoaderDynamic const& loader) {
+
+    if(m_hostPointerAlignment == 0) {
+        return false;
+    }
+
+    MappedFile const& mapping = file.mapping();
+    if(reinterpret_cast<std::uintptr_t>(mapping.data()) % m_hostPointerAlignment != 0 || mapping.size() % m_hostPointerAlignment != 0) {
+        return false;
+    }
+
+    vk::MemoryHostPointerPropertiesEXT hostPointerProperties
+    {
+        .sType = vk::StructureType::eMemoryHostPointerPropertiesEXT,
+        .pNext = {},
+        .memoryTypeBits = {}
+    };
+
+    if(m_device.getMemoryHostPointerPropertiesEXT(vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT, mapping.data(), &hostPointerProperties, loader) != vk::Result::eSuccess) {
+        return false;
+    }
+
+    vk::ExternalMemoryBufferCreateInfo const externalMemoryBufferCreateInfo
+    {
+        .sType = vk::StructureType::eExternalMemoryBufferCreateInfo,
+        .pNext = {},
+        .handleTypes = vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT
+    };
+
+    vk::BufferCreateInfo const bufferCreateInfo
+    {
+        .sType = vk::StructureType::eBufferCreateInfo,
+        .pNext = &externalMemoryBufferCreateInfo,
+        .flags = {},
+        .size = mapping.size(),
+        .usage = vk::BufferUsageFlagBits::eTransferSrc,
+        .sharingMode = vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = {},
+        .pQueueFamilyIndices = {}
+    };
+
+    vk::Buffer buffer {};
+    if(m_device.createBuffer(&bufferCreateInfo, nullptr, &buffer, loader) != vk::Result::eSuccess) {
+        return false;
+    }
+
+    vk::MemoryRequirements const requirements = m_device.getBufferMemoryRequirements(buffer, loader);
+    uint32_t const memoryTypeBits = requirements.memoryTypeBits & hostPointerProperties.memoryTypeBits;
+    if(memoryTypeBits == 0 || requirements.size > mapping.size()) {
+        m_device.destroyBuffer(buffer, nullptr, loader);
+        return false;
+    }
+
+    vk::ImportMemoryHostPointerInfoEXT const importMemoryHostPointerInfo
+    {
+        .sType = vk::StructureType::eImportMemoryHostPointerInfoEXT,
+        .pNext = {},
+        .handleType = vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT,
+        .pHostPointer = mapping.data()
+    };
+
+    vk::MemoryAllocateInfo const memoryAllocateInfo
+    {
+        .sType = vk::StructureType::eMemoryAllocateInfo,
+        .pNext = &importMemoryHostPointerInfo,
+        .allocationSize = mapping.size(),
+        .memoryTypeIndex = static_cast<uint32_t>(std::countr_zero(memoryTypeBits))
+    };
+
+    vk::DeviceMemory memory {};
+    if(m_device.allocateMemory(&memoryAllocateInfo, nullptr, &memory, loader) != vk::Result::eSuccess) {
+        m_device.destroyBuffer(buffer, nullptr, loader);
+        return false;
+    }
+
+    m_device.bindBufferMemory(buffer, memory, 0, loader);
+
+    std::vector<vk::BufferImageCopy> regions(texture.levels);
+    for(uint32_t x=0; x<texture.levels; x++) {
+        regions[x] = vk::BufferImageCopy
+        {
+            .bufferOffset = file.offset(x),
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = vk::ImageSubresourceLayers { .aspectMask = vk::ImageAspectFlagBits::eColor, .mipLevel = x, .baseArrayLayer = 0, .layerCount = texture.layers },
+            .imageOffset = vk::Offset3D { .x = 0, .y = 0, .z = 0 },
+            .imageExtent = file.extent(x)
+        };
+    }
+
+    vk::ImageSubresourceRange const range
+    {
+        .aspectMask = vk::ImageAspectFlagBits::eColor,
+        .baseMipLevel = 0,
+        .levelCount = texture.levels,
+        .baseArrayLayer = 0,
+        .layerCount = texture.layers
+    };
+
+    texture.uploadValue = m_uploader->copyBufferToImage(buffer, texture.image, range, regions, vk::ImageLayout::eShaderReadOnlyOptimal, loader);
+    m_imports.push_back(Import { .buffer = buffer, .memory = memory, .file = std::move(file), .value = texture.uploadValue });
+
+    return true;
+}
+
+Texture TextureLoader::load(std::filesystem::path const& path, vk::DispatchLoaderDynamic const& loader) {
+
+    collect(loader);
+
+    TextureFile file;
+    file.open(path);
+
+    vk::FormatFeatureFlags const requiredFeatures = vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eTransferDst;
+    if((m_physicalDevice.getFormatProperties(file.format(), loader).optimalTilingFeatures & requiredFeatures) != requiredFeatures) {
+        throw std::runtime_error("Error: TextureLoader::load() format cannot be sampled");
+    }
+
+    Texture texture
+    {
+        .image = {},
+        .imageView = {},
+        .allocation = {},
+        .format = file.format(),
+        .extent = file.extent(),
+        .levels = file.levels(),
+        .layers = file.layers(),
+        .uploadValue = {}
+    };
+
+    vk::ImageCreateInfo const imageCreateInfo
+    {
+        .sType = vk::StructureType::eImageCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .imageType = texture.extent.depth > 1 ? vk::ImageType::e3D : vk::ImageType::e2D,
+        .format = texture.format,
+        .extent = texture.extent,
+        .mipLevels = texture.levels,
+        .arrayLayers = texture.layers,
+        .samples = vk::SampleCountFlagBits::e1,
+        .tiling = vk::ImageTiling::eOptimal,
+        .usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
+        .sharingMode = vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = {},
+        .pQueueFamilyIndices = {},
+        .initialLayout = vk::ImageLayout::eUndefined
+    };
+
+    if(m_device.createImage(&imageCreateInfo, nullptr, &texture.image, loader) != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: TextureLoader::load()");
+    }
+
+    try {
+        texture.allocation = m_allocator->allocateImage(texture.image, vk::MemoryPropertyFlagBits::eDeviceLocal, loader);
+        createView(texture, loader);
+
+        if(!importHost(texture, file, loader)) {
+            for(uint32_t x=0; x<texture.levels; x++) {
+                auto const level = file.level(x);
+                vk::ImageSubresourceLayers const subresource { .aspectMask = vk::ImageAspectFlagBits::eColor, .mipLevel = x, .baseArrayLayer = 0, .layerCount = texture.layers };
+                texture.uploadValue = m_uploader->uploadImage(texture.image, subresource, file.extent(x), texture.format, level.data(), level.size(), vk::ImageLayout::eShaderReadOnlyOptimal, loader);
+            }
+        }
+    } catch(...) {
+        release(texture, loader);
+        throw;
+    }
+
+    return texture;
+}
+
+void TextureLoader::createView(Texture& texture, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::ImageViewCreateInfo const imageViewCreateInfo
+    {
+        .sType = vk::StructureType::eImageViewCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .image = texture.image,
+        .viewType = texture.extent.depth > 1 ? vk::ImageViewType::e3D : texture.layers > 1 ? vk::ImageViewType::e2DArray : vk::ImageViewType::e2D,
+        .format = texture.format,
+        .components = {},
+        .subresourceRange = vk::ImageSubresourceRange { .aspectMask = vk::ImageAspectFlagBits::eColor, .baseMipLevel = 0, .levelCount = texture.levels, .baseArrayLayer = 0, .layerCount = texture.layers }
+    };
+
+    if(m_device.createImageView(&imageViewCreateInfo, nullptr, &texture.imageView, loader) != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: TextureLoader::createView()");
+    }
+}
+
+void TextureLoader::release(Texture& texture, vk::DispatchLoaderDynamic const& loader) {
+
+    if(texture.imageView) m_device.destroyImageView(texture.imageView, nullptr, loader);
+    if(texture.image) m_device.destroyImage(texture.image, nullptr, loader);
+    if(texture.allocation.memory) m_allocator->free(texture.allocation, loader);
+
+    texture = Texture {};
+}
+
+void TextureLoader::collect(vk::DispatchLoaderDynamic const& loader) {
+
+    std::erase_if(m_imports, [this, &loader](Import& import) {
+        if(!m_uploader->isComplete(import.value, loader)) {
+            return false;
+        }
+
+        m_device.destroyBuffer(import.buffer, nullptr, loader);
+        m_device.freeMemory(import.memory, nullptr, loader);
+        import.file.close();
+        return true;
+    });
+}
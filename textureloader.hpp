@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "allocator.hpp"
+#include "texturefile.hpp"
+#include "uploader.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+// A sampled image loaded from a texture file. It may be sampled once the
+// graphics queue has acquired uploadValue through the uploader.
+struct Texture {
+    vk::Image                           image           {};
+    vk::ImageView                       imageView       {};
+    Allocation                          allocation      {};
+    vk::Format                          format          {};
+    vk::Extent3D                        extent          {};
+    uint32_t                            levels          {};
+    uint32_t                            layers          {};
+    uint64_t                            uploadValue     {};
+};
+
+// Loads texture files straight from a mapping of the file. With
+// VK_EXT_external_memory_host the mapping is imported as a transfer source
+// and copied without touching the staging ring; otherwise each level is
+// copied from the mapping through staging, in pieces that fit the ring.
+// Imported mappings are kept until their upload has completed and are
+// released by collect().
+class TextureLoader final {
+
+    private:
+        struct Import {
+            vk::Buffer                  buffer          {};
+            vk::DeviceMemory            memory          {};
+            TextureFile                 file            {};
+            uint64_t                    value           {};
+        };
+
+    private:
+        vk::Device                          m_device                    {};
+        vk::PhysicalDevice                  m_physicalDevice            {};
+        Allocator*                          m_allocator                 {};
+        Uploader*                           m_uploader                  {};
+        vk::DeviceSize                      m_hostPointerAlignment      {};
+        std::vector<Import>                 m_imports                   {};
+
+    private:
+        void createView(Texture& texture, vk::DispatchLoaderDynamic const& loader);
+        bool importHost(Texture& texture, TextureFile& file, vk::DispatchLoaderDynamic const& loader);
+
+    public:
+        void create(vk::Device device, vk::PhysicalDevice physicalDevice, Allocator& allocator, Uploader& uploader, vk::DeviceSize hostPointerAlignment);
+        void destroy(vk::DispatchLoaderDynamic const& loader);
+
+        Texture load(std::filesystem::path const& path, vk::DispatchLoaderDynamic const& loader);
+        void release(Texture& texture, vk::DispatchLoaderDynamic const& loader);
+        void collect(vk::DispatchLoaderDynamic const& loader);
+};
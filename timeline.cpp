@@ -0,0 +1,64 @@
+#include "timeline.hpp"
+
+#include <algorithm>
+
+void Timeline::create(vk::Device device, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::SemaphoreTypeCreateInfo const semaphoreTypeCreateInfo
+    {
+        .sType = vk::StructureType::eSemaphoreTypeCreateInfo,
+        .pNext = {},
+        .semaphoreType = vk::SemaphoreType::eTimeline,
+        .initialValue = 0
+    };
+
+    vk::SemaphoreCreateInfo const semaphoreCreateInfo
+    {
+        .sType = vk::StructureType::eSemaphoreCreateInfo,
+        .pNext = &semaphoreTypeCreateInfo,
+        .flags = {}
+    };
+
+    vk::Result result = device.createSemaphore(&semaphoreCreateInfo, nullptr, &m_semaphore, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: Timeline::create()");
+    }
+
+    m_value.store(0, std::memory_order_relaxed);
+    m_completed.store(0, std::memory_order_relaxed);
+}
+
+void Timeline::destroy(vk::Device device, vk::DispatchLoaderDynamic const& loader) {
+    if(m_semaphore) device.destroySemaphore(m_semaphore, nullptr, loader);
+    m_semaphore = vk::Semaphore {};
+}
+
+vk::Semaphore Timeline::semaphore() const {
+    return m_semaphore;
+}
+
+uint64_t Timeline::next() {
+    return m_value.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+uint64_t Timeline::value() const {
+    return m_value.load(std::memory_order_relaxed);
+}
+
+void Timeline::signal(vk::Device device, uint64_t value, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::SemaphoreSignalInfo const semaphoreSignalInfo
+    {
+        .sType = vk::StructureType::eSemaphoreSignalInfo,
+        .pNext = {},
+        .semaphore = m_semaphore,
+        .value = value
+    };
+
+    vk::Result result = device.signalSemaphore(&semaphoreSignalInfo, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: Timeline::signal()");
+    }
+
+    raise(m_value, value);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+// One monotonically increasing counter per queue. Every submission signals the
+// next value, so "has this work finished?" becomes a single integer compare.
+// The counters are atomic because other threads poll a timeline that the
+// render thread advances.
+class Timeline final {
+
+    private:
+        vk::Semaphore                   m_semaphore                 {};
+        std::atomic<uint64_t>           m_value                     {};
+        std::atomic<uint64_t>           m_completed                 {};
+
+    private:
+        static void raise(std::atomic<uint64_t>& counter, uint64_t value) {
+            uint64_t current = counter.load(std::memory_order_relaxed);
+            while(current < value && !counter.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+
+    public:
+        void create(vk::Device device, vk::DispatchLoaderDynamic const& loader);
+        void destroy(vk::Device device, vk::DispatchLoaderDynamic const& loader);
+
+        vk::Semaphore semaphore() const;
+        uint64_t next();
+        uint64_t value() const;
+
+        // Polled every frame, so these take any dispatcher (see FrameDispatch).
+        template<typename Dispatch>
+        uint64_t completed(vk::Device device, Dispatch const& dispatch) {
+
+            if(m_completed.load(std::memory_order_relaxed) < m_value.load(std::memory_order_relaxed)) {
+                uint64_t value {};
+                vk::Result result = device.getSemaphoreCounterValue(m_semaphore, &value, dispatch);
+                if(result != vk::Result::eSuccess) {
+                    throw std::runtime_error("Error: Timeline::completed()");
+                }
+                raise(m_completed, value);
+            }
+
+            return m_completed.load(std::memory_order_relaxed);
+        }
+
+        template<typename Dispatch>
+        bool isComplete(vk::Device device, uint64_t value, Dispatch const& dispatch) {
+            return value <= m_completed.load(std::memory_order_relaxed) || value <= completed(device, dispatch);
+        }
+
+        template<typename Dispatch>
+        void wait(vk::Device device, uint64_t value, Dispatch const& dispatch) {
+
+            if(value <= m_completed.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            vk::SemaphoreWaitInfo const semaphoreWaitInfo
+            {
+                .sType = vk::StructureType::eSemaphoreWaitInfo,
+                .pNext = {},
+                .flags = {},
+                .semaphoreCount = 1,
+                .pSemaphores = &m_semaphore,
+                .pValues = &value
+            };
+
+            vk::Result result = device.waitSemaphores(&semaphoreWaitInfo, UINT64_MAX, dispatch);
+            if(result != vk::Result::eSuccess) {
+                throw std::runtime_error("Error: Timeline::wait()");
+            }
+
+            raise(m_completed, value);
+        }
+
+        void signal(vk::Device device, uint64_t value, vk::DispatchLoaderDynamic const& loader);
+};
@@ -0,0 +1,446 @@
+#include "uploader.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+void Uploader::create(vk::Device device, Allocator& allocator, vk::Queue queue, std::mutex& queueMutex, uint32_t queueFamilyIndex, uint32_t graphicsQueueFamilyIndex, vk::DeviceSize alignment, vk::DispatchLoaderDynamic const& loader, vk::DeviceSize capacity) {
+
+    m_device = device;
+    m_allocator = &allocator;
+    m_queue = queue;
+    m_queueMutex = &queueMutex;
+    m_queueFamilyIndex = queueFamilyIndex;
+    m_graphicsQueueFamilyIndex = graphicsQueueFamilyIndex;
+    m_capacity = capacity;
+    m_alignment = std::max<vk::DeviceSize>(alignment, 16);
+
+    m_timeline.create(m_device, loader);
+
+    vk::BufferCreateInfo const bufferCreateInfo
+    {
+        .sType = vk::StructureType::eBufferCreateInfo,
+        .pNext = {},
+        .flags = {},
+        .size = m_capacity,
+        .usage = vk::BufferUsageFlagBits::eTransferSrc,
+        .sharingMode = vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = {},
+        .pQueueFamilyIndices = {}
+    };
+
+    vk::Result result = m_device.createBuffer(&bufferCreateInfo, nullptr, &m_stagingBuffer, loader);
+    if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Error: Uploader::create()");
+    }
+
+    m_stagingAllocation = m_allocator->allocateBuffer(m_stagingBuffer, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, loader);
+
+    vk::CommandPoolCreateInfo const commandPoolCreateInfo 
+    {
+        .sType = vk::StructureType::eCommandPoolCreateInfo,
+        .pNext = {},
+        .flags = vk::CommandPoolCreateFlagBits::eTransient,
+        .queueFamilyIndex = m_queueFamilyIndex
+    };
+
+    for(auto& batch : m_batches) {
+        result = m_device.createCommandPool(&commandPoolCreateInfo, nullptr, &batch.commandPool, loader);
+        if(result != vk::Result::eSuccess) {
+            throw std::runtime_error("Error: Uploader::create()");
+        }
+
+        vk::CommandBufferAllocateInfo const commandBufferAllocateInfo 
+        {
+            .sType = vk::StructureType::eCommandBufferAllocateInfo,
+            .pNext = {},
+            .commandPool = batch.commandPool,
+            .level = vk::CommandBufferLevel::ePrimary,
+            .commandBufferCount = 1
+        };
+
+        result = m_device.allocateCommandBuffers(&commandBufferAllocateInfo, &batch.commandBuffer, loader);
+        if(result != vk::Result::eSuccess) {
+            throw std::runtime_error("Error: Uploader::create()");
+        }
+    }
+}
+
+void Uploader::destroy(vk::DispatchLoaderDynamic const& loader) {
+
+    if(!m_device) {
+        return;
+    }
+
+    m_timeline.wait(m_device, m_timeline.value(), loader);
+
+    for(auto& batch : m_batches) {
+        if(batch.commandPool) m_device.destroyCommandPool(batch.commandPool, nullptr, loader);
+        batch = Batch {};
+    }
+
+    if(m_stagingBuffer) m_device.destroyBuffer(m_stagingBuffer, nullptr, loader);
+    m_allocator->free(m_stagingAllocation, loader);
+    m_timeline.destroy(m_device, loader);
+
+    m_device = vk::Device {};
+}
+
+bool Uploader::ownershipTransfer() const {
+    return m_queueFamilyIndex != m_graphicsQueueFamilyIndex;
+}
+
+void Uploader::reclaim(vk::DispatchLoaderDynamic const& loader) {
+
+    uint64_t const completed = m_timeline.completed(m_device, loader);
+    for(auto const& batch : m_batches) {
+        if(batch.value != 0 && batch.value <= completed) {
+            m_tail = std::max(m_tail, batch.ringEnd);
+        }
+    }
+}
+
+vk::DeviceSize Uploader::reserve(vk::DeviceSize size, vk::DispatchLoaderDynamic const& loader) {
+
+    if(size > m_capacity) {
+        throw std::runtime_error("Error: Uploader::reserve() upload larger than the staging ring");
+    }
+
+    for(;;) {
+        uint64_t position = (m_head + m_alignment - 1) / m_alignment * m_alignment;
+        if(position % m_capacity + size > m_capacity) {
+            position = (position / m_capacity + 1) * m_capacity;
+        }
+
+        if(position + size - m_tail <= m_capacity) {
+            m_head = position + size;
+            return position % m_capacity;
+        }
+
+        reclaim(loader);
+        if(position + size - m_tail <= m_capacity) {
+            continue;
+        }
+
+        // The ring is full: hand everything recorded so far to the GPU and
+        // wait for the oldest batch still in flight.
+        flush(loader);
+
+        uint64_t oldest = UINT64_MAX;
+        uint64_t const completed = m_timeline.completed(m_device, loader);
+        for(auto const& batch : m_batches) {
+            if(batch.value > completed) {
+                oldest = std::min(oldest, batch.value);
+            }
+        }
+
+        if(oldest == UINT64_MAX) {
+            m_tail = m_head;
+            continue;
+        }
+
+        m_timeline.wait(m_device, oldest, loader);
+        reclaim(loader);
+    }
+}
+
+Uploader::Batch& Uploader::currentBatch(vk::DispatchLoaderDynamic const& loader) {
+
+    Batch& batch = m_batches[m_batchIndex];
+    if(batch.recording) {
+        return batch;
+    }
+
+    m_timeline.wait(m_device, batch.value, loader);
+    m_device.resetCommandPool(batch.commandPool, {}, loader);
+
+    vk::CommandBufferBeginInfo const commandBufferBeginInfo 
+    {
+        .sType = vk::StructureType::eCommandBufferBeginInfo,
+        .pNext = {},
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+        .pInheritanceInfo =  {},
+    };
+
+    batch.commandBuffer.begin(commandBufferBeginInfo, loader);
+    batch.recording = true;
+
+    return batch;
+}
+
+uint64_t Uploader::uploadBuffer(vk::Buffer buffer, vk::DeviceSize offset, void const* data, vk::DeviceSize size, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::DeviceSize uploaded = 0;
+    while(uploaded < size) {
+
+        vk::DeviceSize const chunk = std::min(size - uploaded, m_capacity / 2);
+        vk::DeviceSize const stagingOffset = reserve(chunk, loader);
+        std::memcpy(static_cast<std::byte*>(m_stagingAllocation.mapped) + stagingOffset, static_cast<std::byte const*>(data) + uploaded, chunk);
+
+        vk::BufferCopy const bufferCopy
+        {
+            .srcOffset = stagingOffset,
+            .dstOffset = offset + uploaded,
+            .size = chunk
+        };
+
+        currentBatch(loader).commandBuffer.copyBuffer(m_stagingBuffer, buffer, 1, &bufferCopy, loader);
+        uploaded += chunk;
+    }
+
+    if(ownershipTransfer()) {
+
+        vk::BufferMemoryBarrier const release
+        {
+            .sType = vk::StructureType::eBufferMemoryBarrier,
+            .pNext = {},
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = {},
+            .srcQueueFamilyIndex = m_queueFamilyIndex,
+            .dstQueueFamilyIndex = m_graphicsQueueFamilyIndex,
+            .buffer = buffer,
+            .offset = offset,
+            .size = size
+        };
+
+        currentBatch(loader).commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, release, nullptr, loader);
+
+        vk::BufferMemoryBarrier acquire = release;
+        acquire.setSrcAccessMask({});
+        acquire.setDstAccessMask(vk::AccessFlagBits::eMemoryRead);
+        m_bufferAcquires.push_back(PendingBufferAcquire { .value = 0, .barrier = acquire });
+    }
+
+    return m_timeline.value() + 1;
+}
+
+uint64_t Uploader::uploadImage(vk::Image image, vk::ImageSubresourceLayers const& subresource, vk::Extent3D const& extent, vk::Format format, void const* data, vk::DeviceSize size, vk::ImageLayout finalLayout, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::ImageSubresourceRange const range
+    {
+        .aspectMask = subresource.aspectMask,
+        .baseMipLevel = subresource.mipLevel,
+        .levelCount = 1,
+        .baseArrayLayer = subresource.baseArrayLayer,
+        .layerCount = subresource.layerCount
+    };
+
+    auto const blockExtent = vk::blockExtent(format);
+    uint32_t const columns = (extent.width + blockExtent[0] - 1) / blockExtent[0];
+    uint32_t const rows = (extent.height + blockExtent[1] - 1) / blockExtent[1];
+    uint32_t const slices = (extent.depth + blockExtent[2] - 1) / blockExtent[2];
+
+    // The pieces below are cut from tightly packed data of exactly this size.
+    vk::DeviceSize const expectedSize = static_cast<vk::DeviceSize>(columns) * rows * slices * vk::blockSize(format) * subresource.layerCount;
+    if(expectedSize == 0 || size != expectedSize) {
+        throw std::runtime_error("Error: Uploader::uploadImage() size does not match the extent and format");
+    }
+
+    vk::DeviceSize const layerSize = size / subresource.layerCount;
+    vk::DeviceSize const sliceSize = layerSize / slices;
+    vk::DeviceSize const rowSize = sliceSize / rows;
+    vk::DeviceSize const chunk = m_capacity / 2;
+
+    // Every piece may land in a different batch; the image stays in
+    // TransferDstOptimal on this queue until the last one is recorded.
+    auto const copy = [&](vk::DeviceSize offset, vk::DeviceSize bytes, uint32_t layer, uint32_t layerCount, vk::Offset3D const& imageOffset, vk::Extent3D const& imageExtent) {
+
+        vk::DeviceSize const stagingOffset = reserve(bytes, loader);
+        std::memcpy(static_cast<std::byte*>(m_stagingAllocation.mapped) + stagingOffset, static_cast<std::byte const*>(data) + offset, bytes);
+
+        vk::BufferImageCopy const bufferImageCopy
+        {
+            .bufferOffset = stagingOffset,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = vk::ImageSubresourceLayers { .aspectMask = subresource.aspectMask, .mipLevel = subresource.mipLevel, .baseArrayLayer = subresource.baseArrayLayer + layer, .layerCount = layerCount },
+            .imageOffset = imageOffset,
+            .imageExtent = imageExtent
+        };
+
+        currentBatch(loader).commandBuffer.copyBufferToImage(m_stagingBuffer, image, vk::ImageLayout::eTransferDstOptimal, 1, &bufferImageCopy, loader);
+    };
+
+    recordImageTransfer(image, range, loader);
+
+    if(layerSize <= chunk) {
+        uint32_t const step = static_cast<uint32_t>(chunk / layerSize);
+        for(uint32_t layer = 0; layer < subresource.layerCount; layer += step) {
+            uint32_t const count = std::min(step, subresource.layerCount - layer);
+            copy(layer * layerSize, count * layerSize, layer, count, vk::Offset3D {}, extent);
+        }
+    } else if(sliceSize <= chunk) {
+        uint32_t const step = static_cast<uint32_t>(chunk / sliceSize);
+        for(uint32_t layer = 0; layer < subresource.layerCount; layer++) {
+            for(uint32_t slice = 0; slice < slices; slice += step) {
+                uint32_t const count = std::min(step, slices - slice);
+                uint32_t const z = slice * blockExtent[2];
+                vk::Extent3D const pieceExtent { .width = extent.width, .height = extent.height, .depth = std::min(count * blockExtent[2], extent.depth - z) };
+                copy(layer * layerSize + slice * sliceSize, count * sliceSize, layer, 1, vk::Offset3D { .x = 0, .y = 0, .z = static_cast<int32_t>(z) }, pieceExtent);
+            }
+        }
+    } else {
+        uint32_t const step = static_cast<uint32_t>(std::max<vk::DeviceSize>(chunk / rowSize, 1));
+        for(uint32_t layer = 0; layer < subresource.layerCount; layer++) {
+            for(uint32_t slice = 0; slice < slices; slice++) {
+                for(uint32_t row = 0; row < rows; row += step) {
+                    uint32_t const count = std::min(step, rows - row);
+                    uint32_t const y = row * blockExtent[1];
+                    uint32_t const z = slice * blockExtent[2];
+                    vk::Extent3D const pieceExtent { .width = extent.width, .height = std::min(count * blockExtent[1], extent.height - y), .depth = std::min<uint32_t>(blockExtent[2], extent.depth - z) };
+                    copy(layer * layerSize + slice * sliceSize + row * rowSize, count * rowSize, layer, 1, vk::Offset3D { .x = 0, .y = static_cast<int32_t>(y), .z = static_cast<int32_t>(z) }, pieceExtent);
+                }
+            }
+        }
+    }
+
+    recordImageRelease(image, range, finalLayout, loader);
+    return m_timeline.value() + 1;
+}
+
+uint64_t Uploader::copyBufferToImage(vk::Buffer buffer, vk::Image image, vk::ImageSubresourceRange const& range, std::span<vk::BufferImageCopy const> regions, vk::ImageLayout finalLayout, vk::DispatchLoaderDynamic const& loader) {
+
+    recordImageTransfer(image, range, loader);
+    currentBatch(loader).commandBuffer.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, static_cast<uint32_t>(regions.size()), regions.data(), loader);
+    recordImageRelease(image, range, finalLayout, loader);
+
+    return m_timeline.value() + 1;
+}
+
+void Uploader::recordImageTransfer(vk::Image image, vk::ImageSubresourceRange const& range, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::ImageMemoryBarrier const toTransfer
+    {
+        .sType = vk::StructureType::eImageMemoryBarrier,
+        .pNext = {},
+        .srcAccessMask = {},
+        .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .oldLayout = vk::ImageLayout::eUndefined,
+        .newLayout = vk::ImageLayout::eTransferDstOptimal,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = range
+    };
+
+    currentBatch(loader).commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, toTransfer, loader);
+}
+
+void Uploader::recordImageRelease(vk::Image image, vk::ImageSubresourceRange const& range, vk::ImageLayout finalLayout, vk::DispatchLoaderDynamic const& loader) {
+
+    vk::ImageMemoryBarrier const release
+    {
+        .sType = vk::StructureType::eImageMemoryBarrier,
+        .pNext = {},
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = ownershipTransfer() ? vk::AccessFlags {} : vk::AccessFlagBits::eMemoryRead,
+        .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+        .newLayout = finalLayout,
+        .srcQueueFamilyIndex = ownershipTransfer() ? m_queueFamilyIndex : VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = ownershipTransfer() ? m_graphicsQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = range
+    };
+
+    currentBatch(loader).commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, ownershipTransfer() ? vk::PipelineStageFlagBits::eBottomOfPipe : vk::PipelineStageFlagBits::eAllCommands, {}, nullptr, nullptr, release, loader);
+
+    if(ownershipTransfer()) {
+        vk::ImageMemoryBarrier acquire = release;
+        acquire.setSrcAccessMask({});
+        acquire.setDstAccessMask(vk::AccessFlagBits::eMemoryRead);
+        m_imageAcquires.push_back(PendingImageAcquire { .value = 0, .barrier = acquire });
+    }
+}
+
+uint64_t Uploader::flush(vk::DispatchLoaderDynamic const& loader) {
+
+    Batch& batch = m_batches[m_batchIndex];
+    if(!batch.recording) {
+        return m_timeline.value();
+    }
+
+    batch.commandBuffer.end(loader);
+    batch.value = m_timeline.next();
+    batch.ringEnd = m_head;
+    batch.recording = false;
+
+    vk::Semaphore const semaphore = m_timeline.semaphore();
+
+    vk::TimelineSemaphoreSubmitInfo const timelineSemaphoreSubmitInfo
+    {
+        .sType = vk::StructureType::eTimelineSemaphoreSubmitInfo,
+        .pNext = {},
+        .waitSemaphoreValueCount = 0,
+        .pWaitSemaphoreValues = {},
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &batch.value
+    };
+
+    vk::SubmitInfo const submitInfo
+    {
+        .sType = vk::StructureType::eSubmitInfo,
+        .pNext = &timelineSemaphoreSubmitInfo,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = {},
+        .pWaitDstStageMask = {},
+        .commandBufferCount = 1,
+        .pCommandBuffers = &batch.commandBuffer,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &semaphore,
+    };
+
+    {
+        std::scoped_lock lock(*m_queueMutex);
+        if(vk::Result result = m_queue.submit(1, &submitInfo, {}, loader); result != vk::Result::eSuccess) {
+            throw std::runtime_error("Error: Uploader::flush()");
+        }
+    }
+
+    for(auto& acquire : m_bufferAcquires) {
+        if(acquire.value == 0) acquire.value = batch.value;
+    }
+    for(auto& acquire : m_imageAcquires) {
+        if(acquire.value == 0) acquire.value = batch.value;
+    }
+
+    m_batchIndex = (m_batchIndex + 1) % BatchCount;
+    return batch.value;
+}
+
+uint64_t Uploader::recordAcquireBarriers(vk::CommandBuffer commandBuffer, vk::DispatchLoaderDynamic const& loader) {
+
+    uint64_t const value = m_timeline.value();
+    if(value <= m_acquiredValue) {
+        return 0;
+    }
+    m_acquiredValue = value;
+
+    m_bufferBarriers.clear();
+    m_imageBarriers.clear();
+
+    std::erase_if(m_bufferAcquires, [this](PendingBufferAcquire const& acquire) {
+        if(acquire.value == 0) return false;
+        m_bufferBarriers.push_back(acquire.barrier);
+        return true;
+    });
+
+    std::erase_if(m_imageAcquires, [this](PendingImageAcquire const& acquire) {
+        if(acquire.value == 0) return false;
+        m_imageBarriers.push_back(acquire.barrier);
+        return true;
+    });
+
+    if(!m_bufferBarriers.empty() || !m_imageBarriers.empty()) {
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eAllCommands, {}, nullptr, m_bufferBarriers, m_imageBarriers, loader);
+    }
+
+    return value;
+}
+
+Timeline& Uploader::timeline() {
+    return m_timeline;
+}
+
+bool Uploader::isComplete(uint64_t value, vk::DispatchLoaderDynamic const& loader) {
+    return m_timeline.isComplete(m_device, value, loader);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "allocator.hpp"
+#include "timeline.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+#include "vulkan/vulkan.hpp"
+
+// Streams data through a persistently mapped staging ring on the transfer
+// queue. Copies are batched and submitted by flush(); the graphics queue picks
+// up the queue-family ownership and the timeline value to wait for through
+// recordAcquireBarriers().
+class Uploader final {
+
+    public:
+        static constexpr uint32_t BatchCount = 4;
+
+    private:
+        struct Batch {
+            vk::CommandPool             commandPool     {};
+            vk::CommandBuffer           commandBuffer   {};
+            uint64_t                    value           {};
+            uint64_t                    ringEnd         {};
+            bool                        recording       {};
+        };
+
+        struct PendingBufferAcquire {
+            uint64_t                    value;
+            vk::BufferMemoryBarrier     barrier;
+        };
+
+        struct PendingImageAcquire {
+            uint64_t                    value;
+            vk::ImageMemoryBarrier      barrier;
+        };
+
+    private:
+        vk::Device                          m_device                    {};
+        vk::Queue                           m_queue                     {};
+        std::mutex*                         m_queueMutex                {};
+        uint32_t                            m_queueFamilyIndex          {};
+        uint32_t                            m_graphicsQueueFamilyIndex  {};
+        Allocator*                          m_allocator                 {};
+        Timeline                            m_timeline                  {};
+        vk::Buffer                          m_stagingBuffer             {};
+        Allocation                          m_stagingAllocation         {};
+        vk::DeviceSize                      m_capacity                  {};
+        vk::DeviceSize                      m_alignment                 {};
+        uint64_t                            m_head                      {};
+        uint64_t                            m_tail                      {};
+        uint64_t                            m_acquiredValue             {};
+        uint32_t                            m_batchIndex                {};
+        std::array<Batch, BatchCount>       m_batches                   {};
+        std::vector<PendingBufferAcquire>   m_bufferAcquires            {};
+        std::vector<PendingImageAcquire>    m_imageAcquires             {};
+        std::vector<vk::BufferMemoryBarrier> m_bufferBarriers           {};
+        std::vector<vk::ImageMemoryBarrier> m_imageBarriers             {};
+
+    private:
+        bool ownershipTransfer() const;
+        void reclaim(vk::DispatchLoaderDynamic const& loader);
+        vk::DeviceSize reserve(vk::DeviceSize size, vk::DispatchLoaderDynamic const& loader);
+        Batch& currentBatch(vk::DispatchLoaderDynamic const& loader);
+        void recordImageTransfer(vk::Image image, vk::ImageSubresourceRange const& range, vk::DispatchLoaderDynamic const& loader);
+        void recordImageRelease(vk::Image image, vk::ImageSubresourceRange const& range, vk::ImageLayout finalLayout, vk::DispatchLoaderDynamic const& loader);
+
+    public:
+        void create(vk::Device device, Allocator& allocator, vk::Queue queue, std::mutex& queueMutex, uint32_t queueFamilyIndex, uint32_t graphicsQueueFamilyIndex, vk::DeviceSize alignment, vk::DispatchLoaderDynamic const& loader, vk::DeviceSize capacity = 64ull << 20);
+        void destroy(vk::DispatchLoaderDynamic const& loader);
+
+        uint64_t uploadBuffer(vk::Buffer buffer, vk::DeviceSize offset, void const* data, vk::DeviceSize size, vk::DispatchLoaderDynamic const& loader);
+
+        // Data larger than half the ring is copied in pieces of whole layers,
+        // depth slices or block rows of the given format.
+        uint64_t uploadImage(vk::Image image, vk::ImageSubresourceLayers const& subresource, vk::Extent3D const& extent, vk::Format format, void const* data, vk::DeviceSize size, vk::ImageLayout finalLayout, vk::DispatchLoaderDynamic const& loader);
+
+        // Copies from a caller-owned buffer instead of the staging ring. The
+        // buffer must stay alive until the returned value has completed.
+        uint64_t copyBufferToImage(vk::Buffer buffer, vk::Image image, vk::ImageSubresourceRange const& range, std::span<vk::BufferImageCopy const> regions, vk::ImageLayout finalLayout, vk::DispatchLoaderDynamic const& loader);
+
+        uint64_t flush(vk::DispatchLoaderDynamic const& loader);
+        uint64_t recordAcquireBarriers(vk::CommandBuffer commandBuffer, vk::DispatchLoaderDynamic const& loader);
+
+        Timeline& timeline();
+        bool isComplete(uint64_t value, vk::DispatchLoaderDynamic const& loader);
+};
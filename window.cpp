@@ -1,26 +1,143 @@
 #include "window.hpp"
 
+namespace {
+    // Window whose frame the calling thread is recording, see getFrameAllocator().
+    thread_local Window const* recordingWindow = nullptr;
+
+    // Sets recordingWindow for the duration of recording, also when a record
+    // callback throws.
+    class RecordingScope final {
+
+        public:
+            explicit RecordingScope(Window const* window) {
+                recordingWindow = window;
+            }
+
+            RecordingScope(RecordingScope const&) = delete;
+            RecordingScope& operator = (RecordingScope const&) = delete;
+
+            ~RecordingScope() {
+                recordingWindow = nullptr;
+            }
+    };
+
+    // Window an event belongs to, or 0 for events every window should see.
+    SDL_WindowID eventWindow(SDL_Event const& event) {
+
+        if(event.type >= SDL_EVENT_WINDOW_FIRST && event.type <= SDL_EVENT_WINDOW_LAST) {
+            return event.window.windowID;
+        }
+
+        switch(event.type) {
+            case SDL_EVENT_KEY_DOWN:
+            case SDL_EVENT_KEY_UP:              return event.key.windowID;
+            case SDL_EVENT_TEXT_INPUT:          return event.text.windowID;
+            case SDL_EVENT_MOUSE_MOTION:        return event.motion.windowID;
+            case SDL_EVENT_MOUSE_BUTTON_DOWN:
+            case SDL_EVENT_MOUSE_BUTTON_UP:     return event.button.windowID;
+            case SDL_EVENT_MOUSE_WHEEL:         return event.wheel.windowID;
+            default:                            return 0;
+        }
+    }
+}
+
 void Window::recreateSwaphchain() {
         
-    auto window = SDL_GetWindowFromID(m_window);
-    SDL_GetWindowSize(window, &m_width, &m_height);
+    if(!m_renderThread) {
+        auto window = SDL_GetWindowFromID(m_window);
+        SDL_GetWindowSize(window, &m_width, &m_height);
+    }
+
+    // A minimized window has no drawable surface; it stays dirty and is
+    // redrawn once a resize or restore brings the size back.
+    m_minimized = m_width == 0 || m_height == 0;
+    if(m_minimized) {
+        return;
+    }
 
     vk::SwapchainKHR oldSwapchain = m_swapchain;
-        
-    m_device.waitIdle(m_loader);
+    vk::Format const oldFormat = m_surfaceFormat.format;
+
+    // The deletions capture the context rather than `this`, which a move of
+    // the window would leave dangling.
+    deferDestroy([context = m_context, oldSwapchain, images = std::move(m_images)]() {
+        vk::Device const device = context->getDevice();
+        for(auto const& image : images) {
+            device.destroyFramebuffer(image.framebuffer, nullptr, context->getLoader());
+            device.destroyImageView(image.imageView, nullptr, context->getLoader());
+            device.destroySemaphore(image.presentSemaphore, nullptr, context->getLoader());
+        }
+        device.destroySwapchainKHR(oldSwapchain, nullptr, context->getLoader());
+    });
+    m_images.clear();
+
     createSwapchain(oldSwapchain);
 
-    for(Frame frame : m_frames) {
-        m_device.destroyFramebuffer(frame.framebuffer, nullptr, m_loader);
-        m_device.destroyImageView(frame.imageView, nullptr, m_loader);
+    if(m_surfaceFormat.format != oldFormat) {
+        deferDestroy([context = m_context, renderPass = m_renderPass]() {
+            context->getDevice().destroyRenderPass(renderPass, nullptr, context->getLoader());
+        });
+        createRenderPass();
+
+        if(m_batchRenderer) {
+            vk::Pipeline const pipeline = m_batchRenderer->setTarget(m_renderPass, m_surfaceFormat.format, m_loader);
+            deferDestroy([context = m_context, pipeline]() {
+                context->getDevice().destroyPipeline(pipeline, nullptr, context->getLoader());
+            });
+        }
     }
-        
-    m_device.destroyRenderPass(m_renderPass, nullptr, m_loader);
-    m_device.destroySwapchainKHR(oldSwapchain, nullptr, m_loader);
 
     createImageView();
-    createRenderPass();
     createFramebuffer();
+    createPresentSemaphore();
+
+    // Frames in flight still use the transients sized for the old extent;
+    // they go through the deletion queue and the graph compiles fresh ones.
+    if(m_renderGraph) {
+        retireRenderGraphImages();
+        m_renderGraph->setBackbufferExtent(m_swapchainExtent);
+        m_renderGraph->compile(m_device, m_context->getAllocator(), m_loader);
+    }
+
+    m_dirty = true;
+}
+
+void Window::retireRenderGraphImages() {
+    deferDestroy([context = m_context, retired = m_renderGraph->retireTransientImages()]() {
+        retired.destroy(context->getDevice(), context->getAllocator(), context->getLoader());
+    });
+}
+
+void Window::deferDestroy(std::function<void()> destroy) {
+    m_deletionQueue.push_back(DeferredDeletion { .value = m_context->getGraphicsTimeline().value(), .destroy = std::move(destroy) });
+}
+
+void Window::flushDeletionQueue(uint64_t completedValue) {
+
+    while(!m_deletionQueue.empty() && m_deletionQueue.front().value <= completedValue) {
+        m_deletionQueue.front().destroy();
+        m_deletionQueue.pop_front();
+    }
+}
+
+void Window::collectFrameTiming(Frame& frame) {
+
+    if(!frame.timingPending) {
+        return;
+    }
+    frame.timingPending = false;
+
+    if(frame.queryPool) {
+        std::array<uint64_t, 2> timestamps {};
+        vk::Result result = m_device.getQueryPoolResults(frame.queryPool, 0, 2, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), vk::QueryResultFlagBits::e64, m_loader);
+        if(result == vk::Result::eSuccess) {
+            uint64_t const mask = m_timestampValidBits >= 64 ? ~uint64_t{0} : (uint64_t{1} << m_timestampValidBits) - 1;
+            uint64_t const ticks = ((timestamps[1] & mask) - (timestamps[0] & mask)) & mask;
+            frame.timing.gpuTime = static_cast<uint64_t>(ticks * m_frameTimer->timestampPeriod());
+        }
+    }
+
+    m_frameTimer->push(frame.timing);
 }
 
 void Window::createWindow() {
@@ -47,41 +164,6 @@ void Window::createWindow() {
     m_window = SDL_GetWindowID(window);
 }
 
-void Window::loadVulkanLibrary() {
-    SDL_Vulkan_LoadLibrary(nullptr);
-    m_loader.init(reinterpret_cast<PFN_vkGetInstanceProcAddr>(SDL_Vulkan_GetVkGetInstanceProcAddr()));
-}
-
-void Window::createInstance() {
-
-    m_version = vk::enumerateInstanceVersion(m_loader);
-    std::cout << VK_VERSION_MAJOR(m_version) << "." << VK_VERSION_MINOR(m_version) << "." << VK_VERSION_PATCH(m_version) << std::endl;
-
-    vk::ApplicationInfo applicationInfo {};
-    applicationInfo.setApiVersion(m_version);
-
-    std::vector<const char*> instanceExtensions = { VK_EXT_DEBUG_UTILS_EXTENSION_NAME };
-
-    uint32_t requiredExtensionsCount;
-    auto requiredExtensions = SDL_Vulkan_GetInstanceExtensions(&requiredExtensionsCount);
-    for(uint32_t x=0; x<requiredExtensionsCount; x++) {
-        instanceExtensions.push_back(requiredExtensions[x]);
-    }
-
-    auto instanceLayers = { "VK_LAYER_KHRONOS_validation" };
-
-    vk::InstanceCreateInfo instanceCreateInfo {};
-    instanceCreateInfo.setPApplicationInfo(&applicationInfo);
-    instanceCreateInfo.setPEnabledLayerNames(instanceLayers);
-    instanceCreateInfo.setPEnabledExtensionNames(instanceExtensions);
-
-    vk::Result result = vk::createInstance(&instanceCreateInfo, nullptr, &m_instance, m_loader);
-    if(result != vk::Result::eSuccess) {
-        throw std::runtime_error("Error: Window::createInstance()");
-    }
-    m_loader.init(m_instance);
-}
-
 void Window::createSurface() {
     
     VkSurfaceKHR surface;
@@ -96,78 +178,73 @@ void Window::createSurface() {
 
 }
 
-void Window::createDevice() {
+vk::PresentModeKHR Window::selectPresentMode() const {
 
-    auto m_physicalDevices = m_instance.enumeratePhysicalDevices(m_loader);
-    m_physicalDevice = *(std::find_if(m_physicalDevices.begin(), m_physicalDevices.end(), [this](const auto& m_physicalDevice) {
-        return m_physicalDevice.getProperties(m_loader).deviceType == vk::PhysicalDeviceType::eDiscreteGpu;
-    }));
+    auto const presentModes = m_physicalDevice.getSurfacePresentModesKHR(m_surface, m_loader);
+    auto const supported = [&presentModes](vk::PresentModeKHR presentMode) {
+        return std::ranges::find(presentModes, presentMode) != presentModes.end();
+    };
 
-    std::cout << m_physicalDevice.getProperties(m_loader).deviceName << std::endl;
+    switch(m_framePacing) {
+        case FramePacing::eLowLatency:
+            if(supported(vk::PresentModeKHR::eMailbox)) return vk::PresentModeKHR::eMailbox;
+            if(supported(vk::PresentModeKHR::eImmediate)) return vk::PresentModeKHR::eImmediate;
+            break;
+        case FramePacing::eAdaptive:
+            if(supported(vk::PresentModeKHR::eFifoRelaxed)) return vk::PresentModeKHR::eFifoRelaxed;
+            break;
+        case FramePacing::eVsync:
+            break;
+    }
 
-    auto queueFamilyProperties = m_physicalDevice.getQueueFamilyProperties(m_loader);
-    
-    auto iter = std::find_if(queueFamilyProperties.begin(), queueFamilyProperties.end(), [](const auto& properties) {
-        return properties.queueFlags & vk::QueueFlagBits::eGraphics;
-    });
+    return vk::PresentModeKHR::eFifo;
+}
 
-    const uint32_t graphicsQueueFamilyIndex = std::distance(queueFamilyProperties.begin(), iter);
+uint32_t Window::selectImageCount(vk::SurfaceCapabilitiesKHR const& surfaceCapabilities) const {
 
-    auto priorities {1.0f};
-    std::vector deviceExtensions {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
-    vk::PhysicalDeviceFeatures features;
-    
-    vk::DeviceQueueCreateInfo deviceQueueCreateInfo 
-    {
-        .sType = vk::StructureType::eDeviceQueueCreateInfo,
-        .pNext = {},
-        .flags = {}, 
-        .queueFamilyIndex = graphicsQueueFamilyIndex,
-        .queueCount = 1,
-        .pQueuePriorities = &priorities
-    };
-    
-    vk::DeviceCreateInfo deviceCreateInfo 
-    {
-        .sType = vk::StructureType::eDeviceCreateInfo,
-        .pNext = {},
-        .flags = {},
-        .queueCreateInfoCount = 1,
-        .pQueueCreateInfos = &deviceQueueCreateInfo,
-        .enabledLayerCount = {},
-        .ppEnabledLayerNames = {},
-        .enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
-        .ppEnabledExtensionNames = deviceExtensions.data(),
-        .pEnabledFeatures = &features,
-    };
+    uint32_t imageCount = surfaceCapabilities.minImageCount + 1;
+    if(m_presentMode == vk::PresentModeKHR::eMailbox) {
+        imageCount = std::max(imageCount, 3u);
+    }
 
-    vk::Result result = m_physicalDevice.createDevice(&deviceCreateInfo, nullptr, &m_device, m_loader);
-    if(result != vk::Result::eSuccess) {
-        throw std::runtime_error("Error: Window::createDevice()");
+    if(surfaceCapabilities.maxImageCount != 0) {
+        imageCount = std::min(imageCount, surfaceCapabilities.maxImageCount);
     }
-    m_loader.init(m_device);
 
-    m_queue = m_device.getQueue(graphicsQueueFamilyIndex, 0, m_loader);
+    return imageCount;
 }
 
 void Window::createSwapchain(vk::SwapchainKHR swapchain) {
 
-    m_swapchainExtent = m_physicalDevice.getSurfaceCapabilitiesKHR(m_surface, m_loader).currentExtent;
+    auto const surfaceCapabilities = m_physicalDevice.getSurfaceCapabilitiesKHR(m_surface, m_loader);
+    m_swapchainExtent = surfaceCapabilities.currentExtent;
     m_surfaceFormat = m_physicalDevice.getSurfaceFormatsKHR(m_surface, m_loader).front();
-    auto const presentMode = m_physicalDevice.getSurfacePresentModesKHR(m_surface, m_loader).front();
+
+    if(!m_presentMode) {
+        m_presentMode = selectPresentMode();
+        std::cout << vk::to_string(*m_presentMode) << std::endl;
+    }
+
+    // Only ask for transfer usage while capturing, it can cost the
+    // presentation engine its compressed layouts.
+    m_transferSource = m_frameCapture && (surfaceCapabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferSrc);
+    vk::ImageUsageFlags imageUsage = vk::ImageUsageFlagBits::eColorAttachment;
+    if(m_transferSource) {
+        imageUsage |= vk::ImageUsageFlagBits::eTransferSrc;
+    }
 
     vk::SwapchainCreateInfoKHR swapchainCreateInfo;
     swapchainCreateInfo.setSurface(m_surface);
-    swapchainCreateInfo.setMinImageCount(3);
+    swapchainCreateInfo.setMinImageCount(selectImageCount(surfaceCapabilities));
     swapchainCreateInfo.setImageFormat(m_surfaceFormat.format);
     swapchainCreateInfo.setImageColorSpace(m_surfaceFormat.colorSpace);
     swapchainCreateInfo.setImageExtent(m_swapchainExtent);
     swapchainCreateInfo.setImageArrayLayers(1);
-    swapchainCreateInfo.setImageUsage(vk::ImageUsageFlagBits::eColorAttachment);
+    swapchainCreateInfo.setImageUsage(imageUsage);
     swapchainCreateInfo.setImageSharingMode(vk::SharingMode::eExclusive);
     swapchainCreateInfo.setPreTransform(vk::SurfaceTransformFlagBitsKHR::eIdentity);
     swapchainCreateInfo.setCompositeAlpha(vk::CompositeAlphaFlagBitsKHR::eOpaque);
-    swapchainCreateInfo.setPresentMode(presentMode);
+    swapchainCreateInfo.setPresentMode(*m_presentMode);
     swapchainCreateInfo.setClipped(VK_FALSE);
     swapchainCreateInfo.setOldSwapchain(swapchain);
 
@@ -178,22 +255,60 @@ void Window::createSwapchain(vk::SwapchainKHR swapchain) {
 
     auto images = m_device.getSwapchainImagesKHR(m_swapchain, m_loader);
 
-    m_frames.resize(images.size());
+    m_images.clear();
+    m_images.resize(images.size());
     for(std::size_t x=0; x<images.size(); x++) {
-        m_frames[x].image = images[x];
+        m_images[x].image = images[x];
+    }
+}
+
+void Window::createOffscreenImages() {
+
+    m_surfaceFormat = vk::SurfaceFormatKHR { .format = vk::Format::eR8G8B8A8Unorm, .colorSpace = vk::ColorSpaceKHR::eSrgbNonlinear };
+    m_swapchainExtent = vk::Extent2D { .width = static_cast<uint32_t>(m_width), .height = static_cast<uint32_t>(m_height) };
+    m_transferSource = true;
+
+    m_images.resize(m_imageCount);
+    for(auto& image : m_images) {
+
+        vk::ImageCreateInfo const imageCreateInfo
+        {
+            .sType = vk::StructureType::eImageCreateInfo,
+            .pNext = {},
+            .flags = {},
+            .imageType = vk::ImageType::e2D,
+            .format = m_surfaceFormat.format,
+            .extent = vk::Extent3D { .width = m_swapchainExtent.width, .height = m_swapchainExtent.height, .depth = 1 },
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = vk::SampleCountFlagBits::e1,
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+            .sharingMode = vk::SharingMode::eExclusive,
+            .queueFamilyIndexCount = {},
+            .pQueueFamilyIndices = {},
+            .initialLayout = vk::ImageLayout::eUndefined
+        };
+
+        vk::Result result = m_device.createImage(&imageCreateInfo, nullptr, &image.image, m_loader);
+        if(result != vk::Result::eSuccess) {
+            throw std::runtime_error("Error: Window::createOffscreenImages()");
+        }
+
+        image.allocation = m_context->getAllocator().allocateImage(image.image, vk::MemoryPropertyFlagBits::eDeviceLocal, m_loader);
     }
 }
 
 void Window::createImageView() {
     
-    for(auto& frame : m_frames) {
+    for(auto& image : m_images) {
         
         vk::ImageViewCreateInfo const imageViewCreateInfo 
         {
             .sType = vk::StructureType::eImageViewCreateInfo,
             .pNext = {},
             .flags = {},
-            .image = frame.image,
+            .image = image.image,
             .viewType = vk::ImageViewType::e2D,
             .format = m_surfaceFormat.format,
             .components = vk::ComponentMapping
@@ -213,7 +328,7 @@ void Window::createImageView() {
             }
         };
 
-        vk::Result result = m_device.createImageView(&imageViewCreateInfo, nullptr, &frame.imageView, m_loader);
+        vk::Result result = m_device.createImageView(&imageViewCreateInfo, nullptr, &image.imageView, m_loader);
         if(result != vk::Result::eSuccess) {
             throw std::runtime_error("Error: Window::createImageView()");
         }    
@@ -222,6 +337,10 @@ void Window::createImageView() {
 
 void Window::createRenderPass() {
 
+    if(m_dynamicRendering) {
+        return;
+    }
+
     std::vector const descriptions 
     {
         vk::AttachmentDescription
@@ -234,7 +353,7 @@ void Window::createRenderPass() {
             .stencilLoadOp = vk::AttachmentLoadOp::eDontCare, 
             .stencilStoreOp = vk::AttachmentStoreOp::eDontCare,
             .initialLayout = vk::ImageLayout::eUndefined,
-            .finalLayout = vk::ImageLayout::ePresentSrcKHR
+            .finalLayout = m_headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR
         }
     };
 
@@ -264,19 +383,29 @@ void Window::createRenderPass() {
         }
     };
 
-    /*std::vector const dependencies 
+    std::vector const dependencies 
     {
         vk::SubpassDependency 
         {
             .srcSubpass = VK_SUBPASS_EXTERNAL, 
-            .dstSubpass = {}, 
+            .dstSubpass = 0, 
             .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput, 
             .dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
             .srcAccessMask = {},
             .dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
-            .dependencyFlags = vk::DependencyFlagBits::eByRegion
+            .dependencyFlags = {}
+        },
+        vk::SubpassDependency 
+        {
+            .srcSubpass = 0, 
+            .dstSubpass = VK_SUBPASS_EXTERNAL, 
+            .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput, 
+            .dstStageMask = m_headless ? vk::PipelineStageFlagBits::eTransfer : vk::PipelineStageFlagBits::eBottomOfPipe,
+            .srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+            .dstAccessMask = m_headless ? vk::AccessFlagBits::eTransferRead : vk::AccessFlags {},
+            .dependencyFlags = {}
         }
-    };*/
+    };
     
     vk::RenderPassCreateInfo const renderPassCreateInfo 
     {
@@ -287,8 +416,8 @@ void Window::createRenderPass() {
         .pAttachments = descriptions.data(),
         .subpassCount = static_cast<uint32_t>(supasses.size()),
         .pSubpasses = supasses.data(),
-        //.dependencyCount = static_cast<uint32_t>(dependencies.size()),
-        //.pDependencies = dependencies.data(),
+        .dependencyCount = static_cast<uint32_t>(dependencies.size()),
+        .pDependencies = dependencies.data(),
     };
  
     vk::Result result = m_device.createRenderPass(&renderPassCreateInfo, nullptr, &m_renderPass, m_loader);
@@ -299,9 +428,13 @@ void Window::createRenderPass() {
 
 void Window::createFramebuffer() {
 
+    if(m_dynamicRendering) {
+        return;
+    }
+
     //auto const surfaceCapabilities = m_physicalDevice.getSurfaceCapabilitiesKHR(m_surface, m_loader);
 
-    for(auto& frame : m_frames) {
+    for(auto& image : m_images) {
 
         vk::FramebufferCreateInfo const framebufferCreateInfo
         {
@@ -310,13 +443,13 @@ void Window::createFramebuffer() {
             .flags = {},
             .renderPass = m_renderPass,
             .attachmentCount = 1,
-            .pAttachments = &frame.imageView,
+            .pAttachments = &image.imageView,
             .width = m_swapchainExtent.width,
             .height = m_swapchainExtent.height,
             .layers = 1
         };
 
-        vk::Result result = m_device.createFramebuffer(&framebufferCreateInfo, nullptr, &frame.framebuffer, m_loader);
+        vk::Result result = m_device.createFramebuffer(&framebufferCreateInfo, nullptr, &image.framebuffer, m_loader);
         if(result != vk::Result::eSuccess) {
             throw std::runtime_error("Error: Window::createFramebuffer()");
         }
@@ -333,11 +466,35 @@ void Window::createCommandPool() {
         .queueFamilyIndex = graphicsQueueFamilyIndex
     };
 
+    const vk::CommandPoolCreateInfo threadCommandPoolCreateInfo 
+    {
+        .sType = vk::StructureType::eCommandPoolCreateInfo,
+        .pNext = {},
+        .flags = vk::CommandPoolCreateFlagBits::eTransient,
+        .queueFamilyIndex = graphicsQueueFamilyIndex
+    };
+
+    m_frames.resize(m_framesInFlight);
     for(auto& frame : m_frames) {
         vk::Result result = m_device.createCommandPool(&commandPoolCreateInfo, nullptr, &frame.commandPool, m_loader);
         if(result != vk::Result::eSuccess) {
             throw std::runtime_error("Error: Window::createCommandPool()");
         }   
+
+        frame.threadCommands.resize(m_context->getJobSystem().threadCount() + 1);
+        for(auto& thread : frame.threadCommands) {
+            result = m_device.createCommandPool(&threadCommandPoolCreateInfo, nullptr, &thread.commandPool, m_loader);
+            if(result != vk::Result::eSuccess) {
+                throw std::runtime_error("Error: Window::createCommandPool()");
+            }
+        }
+    }
+}
+
+void Window::createFrameAllocators() {
+
+    for(auto& frame : m_frames) {
+        frame.allocator.create(m_device, m_physicalDevice, m_context->getAllocator(), m_frameAllocatorCapacity, m_loader);
     }
 }
 
@@ -370,209 +527,1373 @@ void Window::createSemaphore() {
     };
 
     for(auto& frame : m_frames) {
-        vk::Result result = m_device.createSemaphore(&semaphoreCreateInfo, nullptr, &frame.signalSemaphore, m_loader);
+        vk::Result result = m_device.createSemaphore(&semaphoreCreateInfo, nullptr, &frame.acquireSemaphore, m_loader);
         if(result != vk::Result::eSuccess) {
             throw std::runtime_error("Error: Window::createSemaphore()");
         }
     }
+}
 
-    for(auto& frame : m_frames) {
-        vk::Result result = m_device.createSemaphore(&semaphoreCreateInfo, nullptr, &frame.waitSemaphore, m_loader);
+void Window::createPresentSemaphore() {
+
+    if(m_headless) {
+        return;
+    }
+
+    const vk::SemaphoreCreateInfo semaphoreCreateInfo {
+        .sType = vk::StructureType::eSemaphoreCreateInfo,
+        .pNext = {},
+        .flags = {}
+    };
+
+    for(auto& image : m_images) {
+        vk::Result result = m_device.createSemaphore(&semaphoreCreateInfo, nullptr, &image.presentSemaphore, m_loader);
         if(result != vk::Result::eSuccess) {
-            throw std::runtime_error("Error: Window::createSemaphore()");
+            throw std::runtime_error("Error: Window::createPresentSemaphore()");
         }
     }
 }
 
-void Window::createFence() {
+void Window::createQueryPool() {
+
+    if(m_timestampValidBits == 0) {
+        return;
+    }
 
-    vk::FenceCreateInfo const fenceCreateInfo
+    vk::QueryPoolCreateInfo const queryPoolCreateInfo
     {
-        .sType = vk::StructureType::eFenceCreateInfo,
+        .sType = vk::StructureType::eQueryPoolCreateInfo,
         .pNext = {},
-        .flags = vk::FenceCreateFlagBits::eSignaled
+        .flags = {},
+        .queryType = vk::QueryType::eTimestamp,
+        .queryCount = 2,
+        .pipelineStatistics = {}
     };
 
     for(auto& frame : m_frames) {
-        vk::Result result = m_device.createFence(&fenceCreateInfo, nullptr, &frame.fence, m_loader);
+        vk::Result result = m_device.createQueryPool(&queryPoolCreateInfo, nullptr, &frame.queryPool, m_loader);
         if(result != vk::Result::eSuccess) {
-            throw std::runtime_error("Error: Window::Fence()");
+            throw std::runtime_error("Error: Window::createQueryPool()");
         }
     }
 }
 
-void Window::show() {
-    auto window = SDL_GetWindowFromID(m_window);
-    SDL_ShowWindow(window);
-}
+void Window::createGpuProfiler() {
 
-void Window::hide() {
-    auto window = SDL_GetWindowFromID(m_window);
-    SDL_HideWindow(window);
-}
+    if(!ProfilingEnabled || m_timestampValidBits == 0) {
+        return;
+    }
 
-void Window::setClearColor(float r, float g, float b) {
-    m_clearValue.color = vk::ClearColorValue { std::array<float, 4>{ r, g, b, 1} };
+    m_gpuProfiler->create(m_device, static_cast<uint32_t>(m_frames.size()), m_timestampValidBits, m_frameTimer->timestampPeriod(), m_loader);
 }
 
-bool Window::shouldShutdown() {
-    return !running;
-}
+void Window::nameFrameObjects() {
 
-void Window::pollEvent() {
+    if(!ProfilingEnabled) {
+        return;
+    }
 
-    while(SDL_PollEvent(&m_event)) 
-    {    
-        switch (m_event.type)
-        {
-            case SDL_EVENT_QUIT:
-                running = false;
-                break;
-        }
+    for(uint32_t x=0; x<m_frames.size(); x++) {
+        Frame const& frame = m_frames[x];
+        std::string const prefix = "frame " + std::to_string(x) + " ";
 
-        if(m_event.key.keysym.sym == SDLK_ESCAPE) {
-            running = false;
+        PROFILE_NAME_OBJECT(m_device, frame.commandPool, (prefix + "command pool").c_str(), m_loader);
+        PROFILE_NAME_OBJECT(m_device, frame.commandBuffer, (prefix + "command buffer").c_str(), m_loader);
+        PROFILE_NAME_OBJECT(m_device, frame.acquireSemaphore, (prefix + "acquire semaphore").c_str(), m_loader);
+        PROFILE_NAME_OBJECT(m_device, frame.queryPool, (prefix + "query pool").c_str(), m_loader);
+
+        for(uint32_t thread=0; thread<frame.threadCommands.size(); thread++) {
+            PROFILE_NAME_OBJECT(m_device, frame.threadCommands[thread].commandPool, (prefix + "worker " + std::to_string(thread) + " command pool").c_str(), m_loader);
         }
     }
 }
 
-void Window::update() {
+void Window::setParallelRecording(uint32_t sliceCount, RecordCallback callback) {
 
-    if(vk::Result result = m_device.waitForFences(1, &m_frames[frameIndex].fence, vk::True, UINT64_MAX, m_loader); result != vk::Result::eSuccess) {
-        throw std::runtime_error("Error: render() Failed to wait for fences");
+    if(m_renderThread) {
+        throw std::runtime_error("Error: Window::setParallelRecording() stop the render thread first");
     }
 
-    if(vk::Result result = m_device.resetFences(1, &m_frames[frameIndex].fence, m_loader); result != vk::Result::eSuccess) {
-        throw std::runtime_error("Error: render() Failed to reset fences");
-    }
+    m_sliceCount = callback ? sliceCount : 0;
+    m_recordCallback = std::move(callback);
+}
 
-    auto imageIndex = m_device.acquireNextImageKHR(m_swapchain, UINT64_MAX, m_frames[frameIndex].waitSemaphore, {}, m_loader); 
-    if(imageIndex.result == vk::Result::eErrorOutOfDateKHR || imageIndex.result == vk::Result::eSuboptimalKHR) {
-        recreateSwaphchain();
-        return;
-    } else if(imageIndex.result != vk::Result::eSuccess) {
-        throw std::runtime_error("Failed to aquire next image");
+uint64_t Window::submitCompute(ComputeQueue::Record const& record, vk::PipelineStageFlags graphicsWaitStages, bool afterPreviousFrame) {
+
+    Timeline& graphicsTimeline = m_context->getGraphicsTimeline();
+    uint64_t const value = m_context->getComputeQueue().submit(record, graphicsTimeline.semaphore(), afterPreviousFrame ? graphicsTimeline.value() : 0, m_loader);
+
+    if(graphicsWaitStages && m_renderThread) {
+        pushCommand(RenderCommand { .type = RenderCommand::Type::eWaitCompute, .value = value, .stages = graphicsWaitStages });
+    } else if(graphicsWaitStages) {
+        m_computeWaitValue = value;
+        m_computeWaitStages |= graphicsWaitStages;
     }
+    return value;
+}
 
-    m_device.resetCommandPool(m_frames[frameIndex].commandPool, {}, m_loader);
+RenderGraph::Resource Window::importBackbuffer(RenderGraph& graph) const {
 
-    vk::RenderPassBeginInfo renderPassBeginInfo 
+    RenderGraph::Access const initial
     {
-        .sType = vk::StructureType::eRenderPassBeginInfo,
-        .pNext = {},
-        .renderPass = m_renderPass,
-        .framebuffer = m_frames[imageIndex.value].framebuffer,
-        .renderArea {
-            .offset = {0, 0},
-            .extent = m_swapchainExtent
-        },
-        .clearValueCount = 1,
-        .pClearValues = &m_clearValue
+        .stages = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        .access = {},
+        .layout = vk::ImageLayout::eUndefined
     };
 
-    vk::CommandBufferBeginInfo const commandBufferBeginInfo 
+    RenderGraph::Access const final
     {
-        .sType = vk::StructureType::eCommandBufferBeginInfo,
-        .pNext = {},
-        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
-        .pInheritanceInfo =  {},
+        .stages = m_headless ? vk::PipelineStageFlags { vk::PipelineStageFlagBits::eTransfer } : vk::PipelineStageFlags {},
+        .access = m_headless ? vk::AccessFlags { vk::AccessFlagBits::eTransferRead } : vk::AccessFlags {},
+        .layout = m_headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR
     };
 
-    m_frames[frameIndex].commandBuffer.begin(commandBufferBeginInfo, m_loader);
-    m_frames[frameIndex].commandBuffer.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline, m_loader);
-    m_frames[frameIndex].commandBuffer.endRenderPass(m_loader);
-    m_frames[frameIndex].commandBuffer.end(m_loader);
+    return graph.importImage("backbuffer", m_images.front().image, m_images.front().imageView, initial, final);
+}
 
-    vk::PipelineStageFlags waitMask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-    vk::SubmitInfo const submitInfo
-    {
-        .sType = vk::StructureType::eSubmitInfo,
-        .pNext = {},
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &m_frames[frameIndex].waitSemaphore,
-        .pWaitDstStageMask = &waitMask,
-        .commandBufferCount = 1,
-        .pCommandBuffers = &(m_frames[frameIndex].commandBuffer),
-        .signalSemaphoreCount = 1,
-        .pSignalSemaphores = &m_frames[frameIndex].signalSemaphore,
-    };
+void Window::setRenderGraph(std::shared_ptr<RenderGraph> graph, RenderGraph::Resource backbuffer) {
 
-    if(vk::Result result = m_queue.submit(1, &submitInfo, m_frames[frameIndex].fence, m_loader); result != vk::Result::eSuccess) {
-        throw std::runtime_error("Could not submitted");
+    if(m_renderThread) {
+        pushCommand(RenderCommand { .type = RenderCommand::Type::eSetRenderGraph, .renderGraph = std::move(graph), .backbuffer = backbuffer });
+        return;
     }
 
-    vk::PresentInfoKHR const presentInfo 
-    {
-        .sType = vk::StructureType::ePresentInfoKHR,
-        .pNext = {},
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &m_frames[frameIndex].signalSemaphore,
-        .swapchainCount = 1,
-        .pSwapchains = &m_swapchain,
-        .pImageIndices = &imageIndex.value,
-        .pResults = nullptr
-    };
+    applyRenderGraph(std::move(graph), backbuffer);
+}
 
-    if(vk::Result result = m_queue.presentKHR(&presentInfo, m_loader); result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR) {
-        recreateSwaphchain();
-    } else if(result != vk::Result::eSuccess) {
-        throw std::runtime_error("Could not queue present");   
+void Window::applyRenderGraph(std::shared_ptr<RenderGraph> graph, RenderGraph::Resource backbuffer) {
+
+    if(m_renderGraph) {
+        retireRenderGraphImages();
+        if(m_renderGraph != graph) m_renderGraph->destroy(m_loader);
     }
 
-    frameIndex++;
-    frameIndex = frameIndex % static_cast<uint32_t>(m_frames.size());
+    m_renderGraph = std::move(graph);
+    m_backbuffer = backbuffer;
+
+    if(m_renderGraph) {
+        m_renderGraph->setBackbufferExtent(m_swapchainExtent);
+        m_renderGraph->compile(m_device, m_context->getAllocator(), m_loader);
+    }
 }
 
-void Window::cleanUp() {
+vk::Device Window::getDevice() const {
+    return m_device;
+}
 
-    m_device.waitIdle(m_loader);
+vk::DispatchLoaderDynamic const& Window::getLoader() const {
+    return m_loader;
+}
 
-    for(auto& frame : m_frames) {
-        if(frame.fence) m_device.destroyFence(frame.fence, nullptr, m_loader);
-        if(frame.waitSemaphore) m_device.destroySemaphore(frame.waitSemaphore, nullptr, m_loader);
-        if(frame.signalSemaphore) m_device.destroySemaphore(frame.signalSemaphore, nullptr, m_loader);       
-        if(frame.commandPool) m_device.destroyCommandPool(frame.commandPool, nullptr, m_loader);
-        if(frame.framebuffer) m_device.destroyFramebuffer(frame.framebuffer, nullptr, m_loader);
-        if(frame.imageView) m_device.destroyImageView(frame.imageView, nullptr, m_loader);
+DeviceDispatch const& Window::getDeviceDispatch() const {
+    return m_deviceDispatch;
+}
+
+vk::Queue Window::getQueue() const {
+    return m_queue;
+}
+
+uint32_t Window::getQueueFamilyIndex() const {
+    return graphicsQueueFamilyIndex;
+}
+
+vk::Extent2D Window::getExtent() const {
+    return m_swapchainExtent;
+}
+
+vk::Format Window::getColorFormat() const {
+    return m_surfaceFormat.format;
+}
+
+BindlessTable& Window::getBindlessTable() {
+    return m_context->getBindlessTable();
+}
+
+// Only the thread recording a frame may allocate from it: outside recording
+// frameIndex may already name a frame that is still in flight. Parallel
+// recording slices run on job workers and are refused as well: the allocator
+// is not thread safe, so it is not available with setParallelRecording().
+FrameAllocator& Window::getFrameAllocator() {
+
+    if(recordingWindow != this) {
+        throw std::runtime_error("Error: Window::getFrameAllocator() called outside frame recording");
     }
 
-    if(m_renderPass) m_device.destroyRenderPass(m_renderPass, nullptr, m_loader);
-    
-    if(m_swapchain) m_device.destroySwapchainKHR(m_swapchain, nullptr, m_loader);
-    if(m_device) m_device.destroy(nullptr, m_loader);
-    if(m_surface) m_instance.destroySurfaceKHR(m_surface, nullptr, m_loader);
-    if(m_instance) m_instance.destroy(nullptr, m_loader);
+    return m_frames[frameIndex].allocator;
+}
 
-    SDL_Vulkan_UnloadLibrary();
-    if(m_window != 0) {
-        auto window = SDL_GetWindowFromID(m_window);
-        SDL_DestroyWindow(window);
-    } 
-    
-        
-    SDL_Quit();
+BatchRenderer& Window::createBatchRenderer(BatchRenderer::Shaders const& shaders, uint32_t instanceCapacity, uint32_t meshCapacity) {
+
+    if(!m_indirectDrawing) {
+        throw std::runtime_error("Error: Window::createBatchRenderer() indirect count drawing is not supported");
+    }
+
+    if(m_renderThread) {
+        throw std::runtime_error("Error: Window::createBatchRenderer() stop the render thread first");
+    }
+
+    waitIdle();
+    if(m_batchRenderer) m_batchRenderer->destroy(m_loader);
+
+    m_batchRenderer = std::make_shared<BatchRenderer>();
+    m_batchRenderer->create(m_device, m_context->getAllocator(), shaders, m_renderPass, m_surfaceFormat.format, m_context->getPipelineCache().cache(), m_loader, instanceCapacity, meshCapacity);
+    return *m_batchRenderer;
 }
 
-Window Window::createDefaultWindow() {
+BatchRenderer& Window::getBatchRenderer() {
 
-    Window window;
+    if(m_renderThread) {
+        throw std::runtime_error("Error: Window::getBatchRenderer() stop the render thread first");
+    }
 
-    try {
+    return *m_batchRenderer;
+}
+
+// The render thread records into and collects from the capture ring and
+// recreates the swapchain on its own, so captures are set up while it is stopped.
+void Window::startCapture(FrameCapture::Encoder encoder, uint32_t slotCount) {
+
+    if(m_renderThread) {
+        throw std::runtime_error("Error: Window::startCapture() stop the render thread first");
+    }
+
+    if(!FrameCapture::supported(m_surfaceFormat.format)) {
+        throw std::runtime_error("Error: Window::startCapture() unsupported surface format");
+    }
+
+    if(!m_headless && !(m_physicalDevice.getSurfaceCapabilitiesKHR(m_surface, m_loader).supportedUsageFlags & vk::ImageUsageFlagBits::eTransferSrc)) {
+        throw std::runtime_error("Error: Window::startCapture() swapchain images cannot be copied");
+    }
 
-        window.createWindow();
-        window.loadVulkanLibrary();
-        window.createInstance();
-        window.createSurface();
-        window.createDevice();
-        window.createSwapchain();
-        window.createImageView();
-        window.createRenderPass();
-        window.createFramebuffer();
-        window.createCommandPool();
-        window.allocateCommandBuffer();
-        window.createSemaphore();
-        window.createFence();
+    stopCapture();
 
+    m_frameCapture = std::make_shared<FrameCapture>();
+    m_frameCapture->create(m_device, m_context->getAllocator(), std::move(encoder), slotCount);
+
+    if(!m_headless) {
+        recreateSwaphchain();
+    }
+}
+
+void Window::stopCapture() {
+
+    if(!m_frameCapture) {
+        return;
+    }
+
+    if(m_renderThread) {
+        throw std::runtime_error("Error: Window::stopCapture() stop the render thread first");
+    }
+
+    waitIdle();
+    m_frameCapture->destroy(m_loader);
+    m_frameCapture.reset();
+}
+
+FrameCapture& Window::getFrameCapture() {
+
+    if(m_renderThread) {
+        throw std::runtime_error("Error: Window::getFrameCapture() stop the render thread first");
+    }
+
+    return *m_frameCapture;
+}
+
+ComputeQueue& Window::getComputeQueue() {
+    return m_context->getComputeQueue();
+}
+
+JobSystem& Window::getJobSystem() {
+    return m_context->getJobSystem();
+}
+
+PipelineCache& Window::getPipelineCache() {
+    return m_context->getPipelineCache();
+}
+
+TextureLoader& Window::getTextureLoader() {
+
+    if(m_renderThread) {
+        throw std::runtime_error("Error: Window::getTextureLoader() stop the render thread first");
+    }
+
+    return m_context->getTextureLoader();
+}
+
+void Window::setFramePacing(FramePacing framePacing) {
+
+    if(m_renderThread) {
+        pushCommand(RenderCommand { .type = RenderCommand::Type::eSetFramePacing, .framePacing = framePacing });
+        return;
+    }
+
+    m_framePacing = framePacing;
+    m_presentMode.reset();
+
+    if(m_swapchain) {
+        recreateSwaphchain();
+    }
+}
+
+std::optional<vk::PresentModeKHR> Window::getPresentMode() const {
+
+    if(m_renderThread) {
+        throw std::runtime_error("Error: Window::getPresentMode() stop the render thread first");
+    }
+
+    return m_presentMode;
+}
+
+void Window::show() {
+    auto window = SDL_GetWindowFromID(m_window);
+    SDL_ShowWindow(window);
+}
+
+void Window::hide() {
+    auto window = SDL_GetWindowFromID(m_window);
+    SDL_HideWindow(window);
+}
+
+void Window::setClearColor(float r, float g, float b) {
+
+    if(m_renderThread) {
+        pushCommand(RenderCommand { .type = RenderCommand::Type::eSetClearColor, .color = { r, g, b, 1 } });
+        return;
+    }
+
+    m_clearValue.color = vk::ClearColorValue { std::array<float, 4>{ r, g, b, 1} };
+    m_dirty = true;
+}
+
+void Window::setRenderOnDemand(bool enabled, int32_t idleTimeout) {
+
+    m_idleTimeout = idleTimeout;
+
+    if(m_renderThread) {
+        pushCommand(RenderCommand { .type = RenderCommand::Type::eSetRenderOnDemand, .enabled = enabled });
+        return;
+    }
+
+    m_renderOnDemand = enabled;
+    m_dirty = true;
+}
+
+void Window::requestRedraw() {
+
+    if(m_renderThread) {
+        pushCommand(RenderCommand { .type = RenderCommand::Type::eRedraw });
+        return;
+    }
+
+    m_dirty = true;
+}
+
+void Window::setEventCallback(EventCallback callback) {
+
+    if(m_renderThread) {
+        throw std::runtime_error("Error: Window::setEventCallback() stop the render thread first");
+    }
+
+    m_eventCallback = std::move(callback);
+}
+
+void Window::startRenderThread() {
+
+    if(m_renderThread || m_headless) {
+        return;
+    }
+
+    if(m_context->windowCount() > 1) {
+        throw std::runtime_error("Error: Window::startRenderThread() windows sharing a context are rendered with Window::updateAll()");
+    }
+
+    m_renderThread = std::make_shared<RenderThread>();
+    m_renderThread->thread = std::thread([this] { renderLoop(); });
+}
+
+void Window::stopRenderThread() {
+
+    if(!m_renderThread) {
+        return;
+    }
+
+    m_renderThread->stop.store(true, std::memory_order_release);
+    m_renderThread->wake.fetch_add(1, std::memory_order_release);
+    m_renderThread->wake.notify_one();
+    m_renderThread->thread.join();
+    m_renderThread.reset();
+}
+
+void Window::pushCommand(RenderCommand const& command) {
+
+    while(!m_renderThread->commands.tryPush(command)) {
+        std::this_thread::yield();
+    }
+
+    m_renderThread->wake.fetch_add(1, std::memory_order_release);
+    m_renderThread->wake.notify_one();
+}
+
+void Window::applyCommand(RenderCommand const& command) {
+
+    switch(command.type) {
+        case RenderCommand::Type::eEvent:
+            if(m_eventCallback) m_eventCallback(command.event);
+            break;
+        case RenderCommand::Type::eResize:
+            m_width = command.width;
+            m_height = command.height;
+            m_minimized = m_width == 0 || m_height == 0;
+            if(m_swapchainExtent.width != static_cast<uint32_t>(m_width) || m_swapchainExtent.height != static_cast<uint32_t>(m_height)) {
+                recreateSwaphchain();
+            }
+            m_dirty = true;
+            break;
+        case RenderCommand::Type::eSetClearColor:
+            m_clearValue.color = vk::ClearColorValue { command.color };
+            m_dirty = true;
+            break;
+        case RenderCommand::Type::eRedraw:
+            m_dirty = true;
+            break;
+        case RenderCommand::Type::eSetMinimized:
+            m_minimized = command.enabled;
+            m_dirty = true;
+            break;
+        case RenderCommand::Type::eSetRenderOnDemand:
+            m_renderOnDemand = command.enabled;
+            m_dirty = true;
+            break;
+        case RenderCommand::Type::eSetFramePacing:
+            m_framePacing = command.framePacing;
+            m_presentMode.reset();
+            if(m_swapchain) recreateSwaphchain();
+            break;
+        case RenderCommand::Type::eWaitCompute:
+            m_computeWaitValue = command.value;
+            m_computeWaitStages |= command.stages;
+            break;
+        case RenderCommand::Type::eSetRenderGraph:
+            applyRenderGraph(command.renderGraph, command.backbuffer);
+            break;
+    }
+}
+
+void Window::renderLoop() {
+
+    RenderThread& renderThread = *m_renderThread;
+    PROFILE_THREAD("render");
+
+    while(!renderThread.stop.load(std::memory_order_acquire)) {
+
+        uint32_t const wake = renderThread.wake.load(std::memory_order_acquire);
+
+        RenderCommand command;
+        while(renderThread.commands.tryPop(command)) {
+            applyCommand(command);
+        }
+
+        if(needsRedraw()) {
+            renderFrame();
+        } else {
+            renderThread.wake.wait(wake, std::memory_order_acquire);
+        }
+    }
+}
+
+bool Window::needsRedraw() const {
+    return m_headless || (!m_minimized && (!m_renderOnDemand || m_dirty));
+}
+
+Allocator& Window::getAllocator() {
+    return m_context->getAllocator();
+}
+
+// The uploader, batch renderer and texture loader are driven by the render
+// thread while it runs and take no locks, so they are only handed out while
+// it is stopped.
+Uploader& Window::getUploader() {
+
+    if(m_renderThread) {
+        throw std::runtime_error("Error: Window::getUploader() stop the render thread first");
+    }
+
+    return m_context->getUploader();
+}
+
+Timeline& Window::getGraphicsTimeline() {
+    return m_context->getGraphicsTimeline();
+}
+
+bool Window::isFrameComplete(uint64_t timelineValue) {
+    return m_context->getGraphicsTimeline().isComplete(m_device, timelineValue, m_loader);
+}
+
+bool Window::usesDynamicRendering() const {
+    return m_dynamicRendering;
+}
+
+bool Window::supportsIndirectDrawing() const {
+    return m_indirectDrawing;
+}
+
+bool Window::shouldShutdown() {
+    return !running;
+}
+
+void Window::handleEvent(SDL_Event const& event) {
+
+    bool redraw = false;
+    bool resize = false;
+    std::optional<bool> minimized;
+
+    switch (event.type)
+    {
+        case SDL_EVENT_QUIT:
+        case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
+            running = false;
+            break;
+        case SDL_EVENT_WINDOW_MINIMIZED:
+            minimized = true;
+            break;
+        case SDL_EVENT_WINDOW_RESTORED:
+        case SDL_EVENT_WINDOW_MAXIMIZED:
+            minimized = false;
+            redraw = true;
+            break;
+        case SDL_EVENT_WINDOW_SHOWN:
+        case SDL_EVENT_WINDOW_EXPOSED:
+            redraw = true;
+            break;
+        case SDL_EVENT_WINDOW_RESIZED:
+        case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+            resize = true;
+            break;
+    }
+
+    if(event.key.keysym.sym == SDLK_ESCAPE) {
+        running = false;
+    }
+
+    int width = 0;
+    int height = 0;
+    if(resize) {
+        SDL_GetWindowSize(SDL_GetWindowFromID(m_window), &width, &height);
+    }
+
+    if(!m_renderThread) {
+        if(resize) minimized = width == 0 || height == 0;
+        m_minimized = minimized.value_or(m_minimized);
+        m_dirty = m_dirty || redraw || resize;
+        if(m_eventCallback) m_eventCallback(event);
+        return;
+    }
+
+    if(minimized) {
+        pushCommand(RenderCommand { .type = RenderCommand::Type::eSetMinimized, .enabled = *minimized });
+    }
+
+    if(resize) {
+        pushCommand(RenderCommand { .type = RenderCommand::Type::eResize, .width = width, .height = height });
+    } else if(redraw) {
+        pushCommand(RenderCommand { .type = RenderCommand::Type::eRedraw });
+    }
+
+    if(m_eventCallback) {
+        pushCommand(RenderCommand { .type = RenderCommand::Type::eEvent, .event = event });
+    }
+}
+
+void Window::pollEvent() {
+    Window* const window = this;
+    pollEvents(std::span(&window, 1));
+}
+
+void Window::pollEvents(std::span<Window* const> windows) {
+
+    auto const route = [windows](SDL_Event const& event) {
+        SDL_WindowID const target = eventWindow(event);
+        for(Window* window : windows) {
+            if(target == 0 || window->m_window == target) window->handleEvent(event);
+        }
+    };
+
+    bool const idle = std::ranges::all_of(windows, [](Window const* window) {
+        return (window->m_renderThread || !window->needsRedraw()) && window->running;
+    });
+
+    // Minimized windows have nothing to draw until a restore or resize event
+    // arrives, so block on SDL without a timeout.
+    bool const minimized = std::ranges::all_of(windows, [](Window const* window) {
+        return !window->m_renderThread && window->m_minimized && !window->m_headless;
+    });
+
+    SDL_Event event;
+    if(idle && !windows.empty()) {
+        int32_t const timeout = minimized ? -1 : (*std::ranges::min_element(windows, {}, &Window::m_idleTimeout))->m_idleTimeout;
+        if(SDL_WaitEventTimeout(&event, timeout)) {
+            route(event);
+        }
+    }
+
+    while(SDL_PollEvent(&event)) 
+    {    
+        route(event);
+    }
+}
+
+void Window::beginRendering(vk::CommandBuffer commandBuffer, uint32_t imageIndex, bool secondary) {
+
+    FrameDispatch const& dispatch = frameDispatch();
+
+    SwapchainImage const& image = m_images[imageIndex];
+
+    if(!m_dynamicRendering) {
+
+        vk::RenderPassBeginInfo renderPassBeginInfo 
+        {
+            .sType = vk::StructureType::eRenderPassBeginInfo,
+            .pNext = {},
+            .renderPass = m_renderPass,
+            .framebuffer = image.framebuffer,
+            .renderArea {
+                .offset = {0, 0},
+                .extent = m_swapchainExtent
+            },
+            .clearValueCount = 1,
+            .pClearValues = &m_clearValue
+        };
+
+        commandBuffer.beginRenderPass(renderPassBeginInfo, secondary ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline, dispatch);
+        return;
+    }
+
+    vk::ImageMemoryBarrier2 const imageMemoryBarrier
+    {
+        .sType = vk::StructureType::eImageMemoryBarrier2,
+        .pNext = {},
+        .srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+        .srcAccessMask = vk::AccessFlagBits2::eNone,
+        .dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+        .dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+        .oldLayout = vk::ImageLayout::eUndefined,
+        .newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image.image,
+        .subresourceRange = 
+        {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    };
+
+    vk::DependencyInfo const dependencyInfo
+    {
+        .sType = vk::StructureType::eDependencyInfo,
+        .pNext = {},
+        .dependencyFlags = {},
+        .memoryBarrierCount = 0,
+        .pMemoryBarriers = {},
+        .bufferMemoryBarrierCount = 0,
+        .pBufferMemoryBarriers = {},
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &imageMemoryBarrier
+    };
+
+    commandBuffer.pipelineBarrier2(dependencyInfo, dispatch);
+
+    vk::RenderingAttachmentInfo const colorAttachment
+    {
+        .sType = vk::StructureType::eRenderingAttachmentInfo,
+        .pNext = {},
+        .imageView = image.imageView,
+        .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+        .resolveMode = vk::ResolveModeFlagBits::eNone,
+        .resolveImageView = {},
+        .resolveImageLayout = vk::ImageLayout::eUndefined,
+        .loadOp = vk::AttachmentLoadOp::eClear,
+        .storeOp = vk::AttachmentStoreOp::eStore,
+        .clearValue = m_clearValue
+    };
+
+    vk::RenderingInfo const renderingInfo
+    {
+        .sType = vk::StructureType::eRenderingInfo,
+        .pNext = {},
+        .flags = secondary ? vk::RenderingFlagBits::eContentsSecondaryCommandBuffers : vk::RenderingFlags {},
+        .renderArea {
+            .offset = {0, 0},
+            .extent = m_swapchainExtent
+        },
+        .layerCount = 1,
+        .viewMask = 0,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &colorAttachment,
+        .pDepthAttachment = {},
+        .pStencilAttachment = {}
+    };
+
+    commandBuffer.beginRendering(renderingInfo, dispatch);
+}
+
+void Window::endRendering(vk::CommandBuffer commandBuffer, uint32_t imageIndex) {
+
+    FrameDispatch const& dispatch = frameDispatch();
+
+    if(!m_dynamicRendering) {
+        commandBuffer.endRenderPass(dispatch);
+        return;
+    }
+
+    commandBuffer.endRendering(dispatch);
+
+    vk::ImageMemoryBarrier2 const imageMemoryBarrier
+    {
+        .sType = vk::StructureType::eImageMemoryBarrier2,
+        .pNext = {},
+        .srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+        .srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+        .dstStageMask = m_headless ? vk::PipelineStageFlagBits2::eTransfer : vk::PipelineStageFlagBits2::eNone,
+        .dstAccessMask = m_headless ? vk::AccessFlagBits2::eTransferRead : vk::AccessFlagBits2::eNone,
+        .oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+        .newLayout = m_headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = m_images[imageIndex].image,
+        .subresourceRange = 
+        {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    };
+
+    vk::DependencyInfo const dependencyInfo
+    {
+        .sType = vk::StructureType::eDependencyInfo,
+        .pNext = {},
+        .dependencyFlags = {},
+        .memoryBarrierCount = 0,
+        .pMemoryBarriers = {},
+        .bufferMemoryBarrierCount = 0,
+        .pBufferMemoryBarriers = {},
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &imageMemoryBarrier
+    };
+
+    commandBuffer.pipelineBarrier2(dependencyInfo, dispatch);
+}
+
+vk::CommandBuffer Window::recordSlice(ThreadCommands& thread, vk::Framebuffer framebuffer, uint32_t slice) {
+
+    if(thread.used == thread.commandBuffers.size()) {
+
+        vk::CommandBufferAllocateInfo const commandBufferAllocateInfo 
+        {
+            .sType = vk::StructureType::eCommandBufferAllocateInfo,
+            .pNext = {},
+            .commandPool = thread.commandPool,
+            .level = vk::CommandBufferLevel::eSecondary,
+            .commandBufferCount = 1
+        };
+
+        vk::CommandBuffer commandBuffer;
+        vk::Result result = m_device.allocateCommandBuffers(&commandBufferAllocateInfo, &commandBuffer, m_loader);
+        if(result != vk::Result::eSuccess) {
+            throw std::runtime_error("Error: Window::recordSlice()");
+        }
+        thread.commandBuffers.push_back(commandBuffer);
+    }
+
+    vk::CommandBuffer commandBuffer = thread.commandBuffers[thread.used++];
+
+    vk::CommandBufferInheritanceRenderingInfo const commandBufferInheritanceRenderingInfo
+    {
+        .sType = vk::StructureType::eCommandBufferInheritanceRenderingInfo,
+        .pNext = {},
+        .flags = {},
+        .viewMask = 0,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &m_surfaceFormat.format,
+        .depthAttachmentFormat = vk::Format::eUndefined,
+        .stencilAttachmentFormat = vk::Format::eUndefined,
+        .rasterizationSamples = vk::SampleCountFlagBits::e1
+    };
+
+    vk::CommandBufferInheritanceInfo const commandBufferInheritanceInfo
+    {
+        .sType = vk::StructureType::eCommandBufferInheritanceInfo,
+        .pNext = m_dynamicRendering ? &commandBufferInheritanceRenderingInfo : nullptr,
+        .renderPass = m_renderPass,
+        .subpass = 0,
+        .framebuffer = framebuffer,
+        .occlusionQueryEnable = vk::False,
+        .queryFlags = {},
+        .pipelineStatistics = {}
+    };
+
+    vk::CommandBufferBeginInfo const commandBufferBeginInfo 
+    {
+        .sType = vk::StructureType::eCommandBufferBeginInfo,
+        .pNext = {},
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+        .pInheritanceInfo = &commandBufferInheritanceInfo,
+    };
+
+    PROFILE_ZONE("recordSlice");
+
+    commandBuffer.begin(commandBufferBeginInfo, m_loader);
+    if(m_batchRenderer && slice == 0) m_batchRenderer->draw(commandBuffer, m_swapchainExtent, m_loader);
+    m_recordCallback(commandBuffer, slice, m_sliceCount);
+    commandBuffer.end(m_loader);
+
+    return commandBuffer;
+}
+
+void Window::recordParallel(Frame& frame, vk::Framebuffer framebuffer) {
+
+    frame.sliceCommandBuffers.resize(m_sliceCount);
+
+    JobCounter counter;
+    for(uint32_t slice=0; slice<m_sliceCount; slice++) {
+        m_context->getJobSystem().submit([this, &frame, framebuffer, slice](uint32_t threadIndex) {
+            frame.sliceCommandBuffers[slice] = recordSlice(frame.threadCommands[threadIndex], framebuffer, slice);
+        }, &counter);
+    }
+
+    m_context->getJobSystem().wait(counter);
+}
+
+void Window::update() {
+
+    if(m_renderThread) {
+        return;
+    }
+
+    renderFrame();
+}
+
+void Window::updateAll(std::span<Window* const> windows) {
+
+    std::vector<Window*> batch;
+    batch.reserve(windows.size());
+    for(Window* window : windows) {
+        if(!window->m_renderThread) batch.push_back(window);
+    }
+
+    renderFrames(batch);
+}
+
+FrameDispatch const& Window::frameDispatch() const {
+#if ENGINE_DEVICE_DISPATCH
+    return m_deviceDispatch;
+#else
+    return m_loader;
+#endif
+}
+
+void Window::renderFrame() {
+    Window* const window = this;
+    renderFrames(std::span(&window, 1));
+}
+
+void Window::renderFrames(std::span<Window* const> windows) {
+
+    if(windows.empty()) {
+        return;
+    }
+
+    PROFILE_ZONE("renderFrame");
+
+    RenderContext& context = *windows.front()->m_context;
+    FrameDispatch const& dispatch = windows.front()->frameDispatch();
+    Timeline& graphicsTimeline = context.getGraphicsTimeline();
+
+    // Checked before any window begins a frame, so a mismatch does not leave
+    // earlier windows with an acquired image and nothing submitted.
+    for(Window* window : windows) {
+        if(window->m_context.get() != &context) {
+            throw std::runtime_error("Error: Window::renderFrames() windows do not share a render context");
+        }
+    }
+
+    std::vector<PendingFrame> pending(windows.size());
+    std::size_t count = 0;
+    for(Window* window : windows) {
+        pending[count] = PendingFrame { .window = window };
+        if(window->beginFrame(pending[count])) {
+            count++;
+        }
+    }
+    pending.resize(count);
+
+    if(pending.empty()) {
+        return;
+    }
+
+    // The uploader is shared, so only the first window records the acquire
+    // barriers; every submission still waits for the transfer queue.
+    uint64_t const uploadValue = std::ranges::max_element(pending, {}, &PendingFrame::uploadValue)->uploadValue;
+
+    std::vector<vk::SubmitInfo> submitInfos;
+    submitInfos.reserve(pending.size());
+    for(auto& frame : pending) {
+        frame.timing.beginPhase(FramePhase::eSubmit);
+        submitInfos.push_back(frame.window->prepareSubmit(frame, graphicsTimeline.next(), uploadValue));
+    }
+
+    {
+        std::scoped_lock lock(context.getQueueMutex());
+        if(vk::Result result = context.getQueue().submit(static_cast<uint32_t>(submitInfos.size()), submitInfos.data(), {}, dispatch); result != vk::Result::eSuccess) {
+            throw std::runtime_error("Could not submitted");
+        }
+    }
+
+    std::vector<vk::Semaphore> presentSemaphores;
+    std::vector<vk::SwapchainKHR> swapchains;
+    std::vector<uint32_t> imageIndices;
+    std::vector<PendingFrame*> presented;
+
+    for(auto& frame : pending) {
+        Window& window = *frame.window;
+        window.endSubmit(frame);
+
+        if(window.m_headless) {
+            continue;
+        }
+
+        frame.timing.beginPhase(FramePhase::ePresent);
+        presentSemaphores.push_back(window.m_images[frame.imageIndex].presentSemaphore);
+        swapchains.push_back(window.m_swapchain);
+        imageIndices.push_back(frame.imageIndex);
+        presented.push_back(&frame);
+    }
+
+    if(swapchains.empty()) {
+        return;
+    }
+
+    std::vector<vk::Result> results(swapchains.size());
+
+    vk::PresentInfoKHR const presentInfo 
+    {
+        .sType = vk::StructureType::ePresentInfoKHR,
+        .pNext = {},
+        .waitSemaphoreCount = static_cast<uint32_t>(presentSemaphores.size()),
+        .pWaitSemaphores = presentSemaphores.data(),
+        .swapchainCount = static_cast<uint32_t>(swapchains.size()),
+        .pSwapchains = swapchains.data(),
+        .pImageIndices = imageIndices.data(),
+        .pResults = results.data()
+    };
+
+    {
+        std::scoped_lock lock(context.getQueueMutex());
+        static_cast<void>(context.getQueue().presentKHR(&presentInfo, dispatch));
+    }
+
+    for(std::size_t x=0; x<presented.size(); x++) {
+        presented[x]->window->endPresent(*presented[x], results[x]);
+    }
+}
+
+bool Window::beginFrame(PendingFrame& pending) {
+
+    if(!needsRedraw()) {
+        return false;
+    }
+
+    FrameDispatch const& dispatch = frameDispatch();
+    Timeline& graphicsTimeline = m_context->getGraphicsTimeline();
+    Uploader& uploader = m_context->getUploader();
+    Frame& frame = m_frames[frameIndex];
+
+    FrameTiming& timing = pending.timing;
+    timing = FrameTiming { .frame = m_frameCount };
+
+    timing.beginPhase(FramePhase::eWaitFrame);
+    graphicsTimeline.wait(m_device, frame.timelineValue, dispatch);
+    timing.endPhase(FramePhase::eWaitFrame);
+
+    collectFrameTiming(frame);
+    frame.allocator.reset();
+    m_gpuProfiler->collect(frameIndex, m_loader);
+    if(m_frameCapture) m_frameCapture->collect(graphicsTimeline.completed(m_device, dispatch));
+    flushDeletionQueue(graphicsTimeline.completed(m_device, dispatch));
+    m_context->getBindlessTable().reclaim(graphicsTimeline.completed(m_device, dispatch));
+
+    timing.beginPhase(FramePhase::eAcquire);
+    uint32_t imageIndex = static_cast<uint32_t>(m_frameCount % m_images.size());
+    if(!m_headless) {
+        vk::Result result = m_device.acquireNextImageKHR(m_swapchain, UINT64_MAX, frame.acquireSemaphore, {}, &imageIndex, dispatch); 
+        if(result == vk::Result::eErrorOutOfDateKHR) {
+            recreateSwaphchain();
+            return false;
+        } else if(result == vk::Result::eSuboptimalKHR) {
+            pending.suboptimal = true;
+        } else if(result != vk::Result::eSuccess) {
+            throw std::runtime_error("Failed to aquire next image");
+        }
+    }
+    pending.imageIndex = imageIndex;
+    timing.endPhase(FramePhase::eAcquire);
+
+    timing.beginPhase(FramePhase::eResetCommandPool);
+    m_device.resetCommandPool(frame.commandPool, {}, dispatch);
+    for(auto& thread : frame.threadCommands) {
+        if(thread.used == 0) continue;
+        m_device.resetCommandPool(thread.commandPool, {}, dispatch);
+        thread.used = 0;
+    }
+    timing.endPhase(FramePhase::eResetCommandPool);
+
+    timing.beginPhase(FramePhase::eRecord);
+
+    vk::CommandBufferBeginInfo const commandBufferBeginInfo 
+    {
+        .sType = vk::StructureType::eCommandBufferBeginInfo,
+        .pNext = {},
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+        .pInheritanceInfo =  {},
+    };
+
+    uploader.flush(m_loader);
+
+    frame.commandBuffer.begin(commandBufferBeginInfo, dispatch);
+    m_gpuProfiler->beginFrame(frameIndex, frame.commandBuffer, m_loader);
+    pending.uploadValue = uploader.recordAcquireBarriers(frame.commandBuffer, m_loader);
+    if(frame.queryPool) {
+        frame.commandBuffer.resetQueryPool(frame.queryPool, 0, 2, dispatch);
+        frame.commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.queryPool, 0, dispatch);
+    }
+    {
+        RecordingScope const recording(this);
+        if(m_renderGraph) {
+            m_renderGraph->setImportedImage(m_backbuffer, m_images[imageIndex].image, m_images[imageIndex].imageView);
+            m_renderGraph->execute(frame.commandBuffer, m_loader, m_gpuProfiler.get());
+        } else {
+            if(m_batchRenderer) {
+                PROFILE_GPU_ZONE(*m_gpuProfiler, frame.commandBuffer, "cull", m_loader);
+                m_batchRenderer->cull(frame.commandBuffer, m_loader);
+            }
+            PROFILE_GPU_ZONE(*m_gpuProfiler, frame.commandBuffer, "render", m_loader);
+            beginRendering(frame.commandBuffer, imageIndex, m_sliceCount != 0);
+            if(m_sliceCount == 0) {
+                if(m_batchRenderer) m_batchRenderer->draw(frame.commandBuffer, m_swapchainExtent, m_loader);
+                if(m_recordCallback) m_recordCallback(frame.commandBuffer, 0, 1);
+            } else {
+                recordParallel(frame, m_images[imageIndex].framebuffer);
+                frame.commandBuffer.executeCommands(frame.sliceCommandBuffers, dispatch);
+            }
+            endRendering(frame.commandBuffer, imageIndex);
+        }
+    }
+    if(m_frameCapture && m_transferSource) {
+        PROFILE_GPU_ZONE(*m_gpuProfiler, frame.commandBuffer, "capture", m_loader);
+        vk::ImageLayout const layout = m_headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+        pending.captureSlot = m_frameCapture->record(frame.commandBuffer, m_images[imageIndex].image, m_swapchainExtent, m_surfaceFormat.format, layout, m_frameCount, m_loader);
+    }
+    if(frame.queryPool) {
+        frame.commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, frame.queryPool, 1, dispatch);
+    }
+    frame.commandBuffer.end(dispatch);
+
+    timing.endPhase(FramePhase::eRecord);
+    return true;
+}
+
+vk::SubmitInfo Window::prepareSubmit(PendingFrame& pending, uint64_t timelineValue, uint64_t uploadValue) {
+
+    Frame& frame = m_frames[frameIndex];
+    frame.timelineValue = timelineValue;
+    if(m_frameCapture) m_frameCapture->submit(pending.captureSlot, timelineValue);
+
+    pending.signalSemaphores = { m_context->getGraphicsTimeline().semaphore(), m_images[pending.imageIndex].presentSemaphore };
+    pending.signalValues = { frame.timelineValue, uint64_t{0} };
+
+    uint32_t& waitCount = pending.waitCount;
+
+    if(!m_headless) {
+        pending.waitSemaphores[waitCount] = frame.acquireSemaphore;
+        pending.waitMasks[waitCount++] = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+    }
+
+    if(uploadValue != 0) {
+        pending.waitSemaphores[waitCount] = m_context->getUploader().timeline().semaphore();
+        pending.waitValues[waitCount] = uploadValue;
+        pending.waitMasks[waitCount++] = vk::PipelineStageFlagBits::eAllCommands;
+    }
+
+    if(m_computeWaitValue != 0) {
+        pending.waitSemaphores[waitCount] = m_context->getComputeQueue().timeline().semaphore();
+        pending.waitValues[waitCount] = m_computeWaitValue;
+        pending.waitMasks[waitCount++] = m_computeWaitStages;
+        m_computeWaitValue = 0;
+        m_computeWaitStages = {};
+    }
+
+    pending.timelineSemaphoreSubmitInfo = vk::TimelineSemaphoreSubmitInfo
+    {
+        .sType = vk::StructureType::eTimelineSemaphoreSubmitInfo,
+        .pNext = {},
+        .waitSemaphoreValueCount = waitCount,
+        .pWaitSemaphoreValues = pending.waitValues.data(),
+        .signalSemaphoreValueCount = m_headless ? 1u : 2u,
+        .pSignalSemaphoreValues = pending.signalValues.data()
+    };
+
+    return vk::SubmitInfo
+    {
+        .sType = vk::StructureType::eSubmitInfo,
+        .pNext = &pending.timelineSemaphoreSubmitInfo,
+        .waitSemaphoreCount = waitCount,
+        .pWaitSemaphores = pending.waitSemaphores.data(),
+        .pWaitDstStageMask = pending.waitMasks.data(),
+        .commandBufferCount = 1,
+        .pCommandBuffers = &frame.commandBuffer,
+        .signalSemaphoreCount = m_headless ? 1u : 2u,
+        .pSignalSemaphores = pending.signalSemaphores.data(),
+    };
+}
+
+void Window::endSubmit(PendingFrame& pending) {
+
+    Frame& frame = m_frames[frameIndex];
+
+    pending.timing.endPhase(FramePhase::eSubmit);
+    m_gpuProfiler->endFrame(pending.timing.end[static_cast<std::size_t>(FramePhase::eSubmit)]);
+
+    frame.timing = pending.timing;
+    frame.timingPending = true;
+    m_frameCount++;
+    m_dirty = false;
+
+    if(m_headless) {
+        frameIndex = (frameIndex + 1) % static_cast<uint32_t>(m_frames.size());
+    }
+}
+
+void Window::endPresent(PendingFrame& pending, vk::Result result) {
+
+    pending.timing.endPhase(FramePhase::ePresent);
+    m_frames[frameIndex].timing = pending.timing;
+
+    if(pending.suboptimal || result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR) {
+        recreateSwaphchain();
+    } else if(result != vk::Result::eSuccess) {
+        throw std::runtime_error("Could not queue present");   
+    }
+
+    frameIndex++;
+    frameIndex = frameIndex % static_cast<uint32_t>(m_frames.size());
+}
+
+FrameTimer const& Window::getFrameTimer() const {
+    return *m_frameTimer;
+}
+
+GpuProfiler& Window::getGpuProfiler() {
+    return *m_gpuProfiler;
+}
+
+void Window::waitIdle() {
+    if(m_device) m_device.waitIdle(m_loader);
+}
+
+void Window::cleanUp() {
+
+    if(!m_context) {
+        return;
+    }
+
+    stopRenderThread();
+    waitIdle();
+    flushDeletionQueue(UINT64_MAX);
+
+    for(auto& frame : m_frames) {
+        if(frame.queryPool) m_device.destroyQueryPool(frame.queryPool, nullptr, m_loader);
+        frame.allocator.destroy(m_context->getAllocator(), m_loader);
+        if(frame.acquireSemaphore) m_device.destroySemaphore(frame.acquireSemaphore, nullptr, m_loader);
+        if(frame.commandPool) m_device.destroyCommandPool(frame.commandPool, nullptr, m_loader);
+        for(auto& thread : frame.threadCommands) {
+            if(thread.commandPool) m_device.destroyCommandPool(thread.commandPool, nullptr, m_loader);
+        }
+    }
+
+    for(auto& image : m_images) {
+        if(image.presentSemaphore) m_device.destroySemaphore(image.presentSemaphore, nullptr, m_loader);
+        if(image.framebuffer) m_device.destroyFramebuffer(image.framebuffer, nullptr, m_loader);
+        if(image.imageView) m_device.destroyImageView(image.imageView, nullptr, m_loader);
+        if(image.allocation.memory) m_device.destroyImage(image.image, nullptr, m_loader);
+        if(image.allocation.memory) m_context->getAllocator().free(image.allocation, m_loader);
+    }
+
+    if(m_renderPass) m_device.destroyRenderPass(m_renderPass, nullptr, m_loader);
+    if(m_device) m_gpuProfiler->destroy(m_loader);
+    
+    if(m_renderGraph) m_renderGraph->destroy(m_loader);
+    if(m_batchRenderer) m_batchRenderer->destroy(m_loader);
+    if(m_frameCapture) m_frameCapture->destroy(m_loader);
+
+    if(m_swapchain) m_device.destroySwapchainKHR(m_swapchain, nullptr, m_loader);
+    if(m_surface) m_instance.destroySurfaceKHR(m_surface, nullptr, m_loader);
+
+    if(m_window != 0) {
+        auto window = SDL_GetWindowFromID(m_window);
+        SDL_DestroyWindow(window);
+    } 
+
+    m_context->detach();
+    m_context.reset();
+}
+
+void Window::attachContext() {
+
+    RenderContext const& context = *m_context;
+
+    m_loader = context.getLoader();
+    m_deviceDispatch = context.getDeviceDispatch();
+    m_instance = context.getInstance();
+    m_physicalDevice = context.getPhysicalDevice();
+    m_device = context.getDevice();
+    m_queue = context.getQueue();
+    graphicsQueueFamilyIndex = context.getQueueFamilyIndex();
+    m_dynamicRendering = context.usesDynamicRendering();
+    m_indirectDrawing = context.supportsIndirectDrawing();
+    m_timestampValidBits = context.getTimestampValidBits();
+    m_frameTimer->setTimestampPeriod(context.getTimestampPeriod());
+}
+
+void Window::startup() {
+
+    StartupReport& report = *m_startupReport;
+    RenderContext& context = *m_context;
+    bool const createContext = !context.getDevice();
+
+    context.attach();
+
+    PROFILE_THREAD("main");
+    if(createContext) {
+        report.measure("loadVulkanLibrary", [&context] { context.loadVulkanLibrary(); });
+    }
+
+    auto device = std::async(std::launch::async, [&context, &report, createContext] {
+        if(!createContext) return;
+        report.measure("createInstance", [&context] { context.createInstance(); });
+        report.measure("createDevice", [&context] { context.createDevice(); });
+    });
+
+    if(!m_headless) {
+        report.measure("createWindow", [this] { createWindow(); });
+    }
+    device.get();
+    attachContext();
+
+    auto frames = std::async(std::launch::async, [this, &context, &report, createContext] {
+        if(createContext) {
+            report.measure("createAllocator", [&context] { context.createAllocator(); });
+            report.measure("createUploader", [&context] { context.createUploader(); });
+            report.measure("createComputeQueue", [&context] { context.createComputeQueue(); });
+            report.measure("createBindlessTable", [&context] { context.createBindlessTable(); });
+            report.measure("createJobSystem", [&context] { context.createJobSystem(); });
+            report.measure("createPipelineCache", [&context] { context.createPipelineCache(); });
+            report.measure("createTextureLoader", [&context] { context.createTextureLoader(); });
+            report.measure("createTimeline", [&context] { context.createTimeline(); });
+        }
+        report.measure("createCommandPool", [this] { createCommandPool(); });
+        report.measure("createFrameAllocators", [this] { createFrameAllocators(); });
+        report.measure("allocateCommandBuffer", [this] { allocateCommandBuffer(); });
+        report.measure("createSemaphore", [this] { createSemaphore(); });
+        report.measure("createQueryPool", [this] { createQueryPool(); });
+        report.measure("createGpuProfiler", [this] { createGpuProfiler(); });
+        report.measure("nameFrameObjects", [this] { nameFrameObjects(); });
+    });
+
+    if(!m_headless) {
+        report.measure("createSurface", [this] { createSurface(); });
+        report.measure("createSwapchain", [this] { createSwapchain(); });
+    }
+
+    if(m_headless) {
+        frames.get();
+        report.measure("createOffscreenImages", [this] { createOffscreenImages(); });
+    }
+
+    report.measure("createImageView", [this] { createImageView(); });
+    report.measure("createRenderPass", [this] { createRenderPass(); });
+    report.measure("createFramebuffer", [this] { createFramebuffer(); });
+    report.measure("createPresentSemaphore", [this] { createPresentSemaphore(); });
+
+    if(frames.valid()) {
+        frames.get();
+    }
+
+    report.print(std::cout);
+}
+
+StartupReport const& Window::getStartupReport() const {
+    return *m_startupReport;
+}
+
+std::shared_ptr<RenderContext> const& Window::getContext() const {
+    return m_context;
+}
+
+Window Window::createDefaultWindow(FramePacing framePacing, uint32_t framesInFlight) {
+
+    if(framesInFlight == 0) {
+        throw std::runtime_error("Error: Window::createDefaultWindow() needs at least one frame in flight");
+    }
+
+    return createSharedWindow(std::make_shared<RenderContext>(), framePacing, framesInFlight);
+}
+
+Window Window::createSharedWindow(std::shared_ptr<RenderContext> context, FramePacing framePacing, uint32_t framesInFlight) {
+
+    if(context->isHeadless()) {
+        throw std::runtime_error("Error: Window::createSharedWindow() a headless context cannot present");
+    }
+
+    if(framesInFlight == 0) {
+        throw std::runtime_error("Error: Window::createSharedWindow() needs at least one frame in flight");
+    }
+
+    Window window;
+    window.m_context = std::move(context);
+    window.m_framePacing = framePacing;
+    window.m_framesInFlight = framesInFlight;
+
+    try {
+        window.startup();
+    } catch(vk::SystemError error) {
+        std::cout << error.code() << std::endl;
+    }
+
+    return window;
+}
+
+Window Window::createHeadlessWindow(int width, int height, uint32_t imageCount, uint32_t framesInFlight) {
+
+    if(imageCount == 0 || framesInFlight == 0) {
+        throw std::runtime_error("Error: Window::createHeadlessWindow() needs at least one image and one frame in flight");
+    }
+
+    Window window;
+    window.m_context = std::make_shared<RenderContext>(true);
+    window.m_headless = true;
+    window.m_width = width;
+    window.m_height = height;
+    window.m_imageCount = imageCount;
+    window.m_framesInFlight = framesInFlight;
+
+    try {
+        window.startup();
     } catch(vk::SystemError error) {
         std::cout << error.code() << std::endl;
     }
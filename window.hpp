@@ -1,35 +1,153 @@
 #pragma once
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
 #include <ranges>
 #include <memory> 
+#include <optional>
+#include <span>
+#include <thread>
 #include <utility>
 
+#include "allocator.hpp"
+#include "batchrenderer.hpp"
+#include "bindless.hpp"
+#include "compute.hpp"
+#include "dispatch.hpp"
+#include "frameallocator.hpp"
+#include "framecapture.hpp"
+#include "frametimer.hpp"
+#include "jobsystem.hpp"
+#include "pipelinecache.hpp"
+#include "profiler.hpp"
+#include "rendercontext.hpp"
+#include "rendergraph.hpp"
+#include "spscqueue.hpp"
+#include "startup.hpp"
+#include "timeline.hpp"
+#include "uploader.hpp"
+
 #define VULKAN_HPP_NO_CONSTRUCTORS
 #include "vulkan/vulkan.hpp"
 
 #include "SDL3/SDL.h"
 #include "SDL3/SDL_vulkan.h"
 
+enum class FramePacing {
+    eLowLatency,
+    eVsync,
+    eAdaptive
+};
+
 class Window final {
 
+    public:
+        using RecordCallback = std::function<void(vk::CommandBuffer commandBuffer, uint32_t slice, uint32_t sliceCount)>;
+        using EventCallback = std::function<void(SDL_Event const& event)>;
+
     private:
-        struct Frame {
+        struct SwapchainImage {
             vk::Image                   image;
+            Allocation                  allocation;
             vk::ImageView               imageView;
             vk::Framebuffer             framebuffer;
+            vk::Semaphore               presentSemaphore;
+        };
+
+        struct DeferredDeletion {
+            uint64_t                    value;
+            std::function<void()>       destroy;
+        };
+
+        struct ThreadCommands {
+            vk::CommandPool                 commandPool;
+            std::vector<vk::CommandBuffer>  commandBuffers;
+            uint32_t                        used {};
+        };
+
+        struct Frame {
             vk::CommandPool             commandPool;
             vk::CommandBuffer           commandBuffer;
-            vk::Semaphore               signalSemaphore;
-            vk::Semaphore               waitSemaphore;
-            vk::Fence                   fence;
+            std::vector<ThreadCommands> threadCommands;
+            std::vector<vk::CommandBuffer> sliceCommandBuffers;
+            vk::Semaphore               acquireSemaphore;
+            uint64_t                    timelineValue {};
+            vk::QueryPool               queryPool;
+            FrameAllocator              allocator;
+            FrameTiming                 timing;
+            bool                        timingPending {};
+        };
+
+        struct RenderCommand {
+            enum class Type {
+                eEvent,
+                eResize,
+                eSetClearColor,
+                eRedraw,
+                eSetMinimized,
+                eSetRenderOnDemand,
+                eSetFramePacing,
+                eWaitCompute,
+                eSetRenderGraph
+            };
+
+            Type                        type {};
+            SDL_Event                   event {};
+            int                         width {};
+            int                         height {};
+            std::array<float, 4>        color {};
+            bool                        enabled {};
+            FramePacing                 framePacing {};
+            uint64_t                    value {};
+            vk::PipelineStageFlags      stages {};
+            std::shared_ptr<RenderGraph> renderGraph {};
+            RenderGraph::Resource       backbuffer {RenderGraph::InvalidResource};
+        };
+
+        // Owned by the main thread while running: it pumps SDL and produces
+        // commands, the render thread consumes them and submits frames.
+        struct RenderThread {
+            std::thread                         thread;
+            std::atomic<bool>                   stop {};
+            std::atomic<uint32_t>               wake {};
+            SpscQueue<RenderCommand, 256>       commands;
+        };
+
+        // One window's part of a batched submit. The submit info points into
+        // it, so it stays in place until the queue submit has returned.
+        struct PendingFrame {
+            Window*                                 window              {};
+            uint32_t                                imageIndex          {};
+            bool                                    suboptimal          {};
+            uint64_t                                uploadValue         {};
+            uint32_t                                captureSlot         {FrameCapture::InvalidSlot};
+            FrameTiming                             timing              {};
+            uint32_t                                waitCount           {};
+            std::array<vk::Semaphore, 3>            waitSemaphores      {};
+            std::array<uint64_t, 3>                 waitValues          {};
+            std::array<vk::PipelineStageFlags, 3>   waitMasks           {};
+            std::array<vk::Semaphore, 2>            signalSemaphores    {};
+            std::array<uint64_t, 2>                 signalValues        {};
+            vk::TimelineSemaphoreSubmitInfo         timelineSemaphoreSubmitInfo {};
         };
 
     private:
         SDL_WindowID                    m_window                    {};
-        SDL_Event                       m_event                     {};
         uint32_t                        frameIndex                  {};
+        uint64_t                        m_frameCount                {};
         bool                            running                     {true};
+        bool                            m_headless                  {false};
+        bool                            m_dynamicRendering          {false};
+        bool                            m_indirectDrawing           {false};
+        bool                            m_transferSource            {false};
+        bool                            m_renderOnDemand            {false};
+        bool                            m_dirty                     {true};
+        bool                            m_minimized                 {false};
+        int32_t                         m_idleTimeout               {100};
         int                             m_width                     {800};
         int                             m_height                    {600};
 
@@ -37,57 +155,152 @@ class Window final {
 
     private:
         uint32_t                        graphicsQueueFamilyIndex    {};
-        uint32_t                        m_version                   {};
+        uint32_t                        m_imageCount                {3};
+        uint32_t                        m_framesInFlight            {2};
+        vk::DeviceSize                  m_frameAllocatorCapacity    {4ull << 20};
+        uint32_t                        m_timestampValidBits        {};
+        std::shared_ptr<FrameTimer>     m_frameTimer                {std::make_shared<FrameTimer>()};
+        std::shared_ptr<GpuProfiler>    m_gpuProfiler               {std::make_shared<GpuProfiler>()};
+        std::shared_ptr<StartupReport>  m_startupReport             {std::make_shared<StartupReport>()};
+        std::shared_ptr<RenderContext>  m_context                   {};
         vk::DispatchLoaderDynamic       m_loader                    {};
+        DeviceDispatch                  m_deviceDispatch            {};
         vk::Instance                    m_instance                  {};
         vk::SurfaceKHR                  m_surface                   {};
         vk::PhysicalDevice              m_physicalDevice            {};
         vk::Device                      m_device                    {};
         vk::Queue                       m_queue                     {};
+        std::shared_ptr<BatchRenderer>  m_batchRenderer             {};
+        std::shared_ptr<FrameCapture>   m_frameCapture              {};
+        uint64_t                        m_computeWaitValue          {};
+        vk::PipelineStageFlags          m_computeWaitStages         {};
+        uint32_t                        m_sliceCount                {};
+        RecordCallback                  m_recordCallback            {};
+        EventCallback                   m_eventCallback             {};
+        std::shared_ptr<RenderGraph>    m_renderGraph               {};
+        RenderGraph::Resource           m_backbuffer                {RenderGraph::InvalidResource};
+        std::shared_ptr<RenderThread>   m_renderThread              {};
         vk::SwapchainKHR                m_swapchain                 {};
         vk::SurfaceFormatKHR            m_surfaceFormat             {};
+        FramePacing                     m_framePacing               {FramePacing::eVsync};
+        std::optional<vk::PresentModeKHR> m_presentMode             {};
         vk::RenderPass                  m_renderPass                {};
         vk::ClearValue                  m_clearValue                {};
 
+        std::vector<SwapchainImage>     m_images                    {};
         std::vector<Frame>              m_frames                    {};
+        std::deque<DeferredDeletion>    m_deletionQueue             {};
 
     private:
         void recreateSwaphchain();
+        void startup();
+        void attachContext();
+        void handleEvent(SDL_Event const& event);
+        void pushCommand(RenderCommand const& command);
+        void applyCommand(RenderCommand const& command);
+        void applyRenderGraph(std::shared_ptr<RenderGraph> graph, RenderGraph::Resource backbuffer);
+        void retireRenderGraphImages();
+        void renderLoop();
+        void renderFrame();
+        static void renderFrames(std::span<Window* const> windows);
+        bool beginFrame(PendingFrame& pending);
+        vk::SubmitInfo prepareSubmit(PendingFrame& pending, uint64_t timelineValue, uint64_t uploadValue);
+        void endSubmit(PendingFrame& pending);
+        void endPresent(PendingFrame& pending, vk::Result result);
+        FrameDispatch const& frameDispatch() const;
+        void deferDestroy(std::function<void()> destroy);
+        void flushDeletionQueue(uint64_t completedValue);
+        void collectFrameTiming(Frame& frame);
+        void beginRendering(vk::CommandBuffer commandBuffer, uint32_t imageIndex, bool secondary);
+        void endRendering(vk::CommandBuffer commandBuffer, uint32_t imageIndex);
+        vk::CommandBuffer recordSlice(ThreadCommands& thread, vk::Framebuffer framebuffer, uint32_t slice);
+        void recordParallel(Frame& frame, vk::Framebuffer framebuffer);
+        vk::PresentModeKHR selectPresentMode() const;
+        uint32_t selectImageCount(vk::SurfaceCapabilitiesKHR const& surfaceCapabilities) const;
 
     public:
         void createWindow();
-        void loadVulkanLibrary();
-        void createInstance();
         void createSurface();
-        void createDevice();
         void createSwapchain(vk::SwapchainKHR swapchain = {});
+        void createOffscreenImages();
         void createImageView();
         void createRenderPass();
         void createFramebuffer();
         void createCommandPool();
+        void createFrameAllocators();
         void allocateCommandBuffer();
         void createSemaphore();
-        void createFence();
+        void createPresentSemaphore();
+        void createQueryPool();
+        void createGpuProfiler();
+        void nameFrameObjects();
 
     public:
+        // A moved-from window has no context and cleanUp() leaves it alone.
+        // Move before startRenderThread(), the render thread keeps `this`.
         Window() = default;
-        Window(Window const&) = default;
+        Window(Window const&) = delete;
         Window(Window&& window) = default;
 
     public:
-        Window& operator = (Window const&) = default;
-        Window& operator = (Window&&) = default;
+        Window& operator = (Window const&) = delete;
+        Window& operator = (Window&&) = delete;
 
     public:
         void show();
         void hide();
         void setClearColor(float r, float g, float b);
+        void setRenderOnDemand(bool enabled, int32_t idleTimeout = 100);
+        void requestRedraw();
+        bool needsRedraw() const;
+        void setEventCallback(EventCallback callback);
+        void startRenderThread();
+        void stopRenderThread();
+        void setFramePacing(FramePacing framePacing);
+        void setParallelRecording(uint32_t sliceCount, RecordCallback callback);
+        JobSystem& getJobSystem();
+        PipelineCache& getPipelineCache();
+        TextureLoader& getTextureLoader();
+        std::optional<vk::PresentModeKHR> getPresentMode() const;
         bool shouldShutdown();
         void pollEvent();
         void update();
+        static void pollEvents(std::span<Window* const> windows);
+        static void updateAll(std::span<Window* const> windows);
+        void waitIdle();
+        FrameTimer const& getFrameTimer() const;
+        GpuProfiler& getGpuProfiler();
+        Allocator& getAllocator();
+        Uploader& getUploader();
+        ComputeQueue& getComputeQueue();
+        BindlessTable& getBindlessTable();
+        FrameAllocator& getFrameAllocator();
+        BatchRenderer& createBatchRenderer(BatchRenderer::Shaders const& shaders, uint32_t instanceCapacity = 1u << 18, uint32_t meshCapacity = 1024);
+        BatchRenderer& getBatchRenderer();
+        void startCapture(FrameCapture::Encoder encoder, uint32_t slotCount = 3);
+        void stopCapture();
+        FrameCapture& getFrameCapture();
+        RenderGraph::Resource importBackbuffer(RenderGraph& graph) const;
+        void setRenderGraph(std::shared_ptr<RenderGraph> graph, RenderGraph::Resource backbuffer);
+        vk::Device getDevice() const;
+        vk::DispatchLoaderDynamic const& getLoader() const;
+        DeviceDispatch const& getDeviceDispatch() const;
+        vk::Queue getQueue() const;
+        uint32_t getQueueFamilyIndex() const;
+        vk::Extent2D getExtent() const;
+        vk::Format getColorFormat() const;
+        uint64_t submitCompute(ComputeQueue::Record const& record, vk::PipelineStageFlags graphicsWaitStages = vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader, bool afterPreviousFrame = false);
+        Timeline& getGraphicsTimeline();
+        bool isFrameComplete(uint64_t timelineValue);
+        bool usesDynamicRendering() const;
+        bool supportsIndirectDrawing() const;
+        StartupReport const& getStartupReport() const;
+        std::shared_ptr<RenderContext> const& getContext() const;
         void cleanUp();
 
-        static Window createDefaultWindow();
+        static Window createDefaultWindow(FramePacing framePacing = FramePacing::eVsync, uint32_t framesInFlight = 2);
+        static Window createSharedWindow(std::shared_ptr<RenderContext> context, FramePacing framePacing = FramePacing::eVsync, uint32_t framesInFlight = 2);
+        static Window createHeadlessWindow(int width, int height, uint32_t imageCount = 3, uint32_t framesInFlight = 2);
 
         virtual ~Window() {
             cleanUp();